@@ -3,6 +3,7 @@
 #include "agents/stupid_agent.hpp"
 #include "agents/nn_agent.hpp"
 #include "agents/manual.hpp"
+#include "model/lidar.hpp"
 #include "utils/imgui.hpp"
 #include "utils/math.hpp"
 
@@ -24,6 +25,10 @@ private:
 	
 	bool m_DrawSensorsState = false;
 
+	bool m_DrawLidar = false;
+	int m_LidarBeams = Lidar::DefaultBeamsCount;
+	Lidar m_Lidar;
+
 	bool m_DrawPath = false;
 	bool m_DrawZones = false;
 	bool m_DrawCoveredPath = true;
@@ -107,6 +112,9 @@ public:
 		ImGui::Separator();
 
 		ImGui::Checkbox("Draw Sensors State", &m_DrawSensorsState);
+		ImGui::Checkbox("Draw Lidar", &m_DrawLidar);
+		if(ImGui::InputInt("Lidar Beams", &m_LidarBeams))
+			m_Lidar = Lidar(std::max(m_LidarBeams, 1));
 		ImGui::Separator();
 		ImGui::Checkbox("Collect Samples", &m_CollectData);
 		ImGui::Text("Samples: %d", m_TraningData.size());
@@ -156,6 +164,11 @@ public:
 		if(m_DrawSensorsState)
 			m_Cleaner.DrawIntersections(rt, m_Env);
 
+		if (m_DrawLidar) {
+			m_Lidar.Scan(m_Cleaner, m_Env);
+			m_Lidar.Draw(rt, m_Cleaner);
+		}
+
 		Agent().DrawDebugData(rt);
 	}
 
@@ -0,0 +1,129 @@
+#include <filesystem>
+#include <bsl/log.hpp>
+#include "allocation_counter.hpp"
+#include "model/evolution_training.hpp"
+#include "benchmark_room.hpp"
+#include "utils/random.hpp"
+#include "config.hpp"
+
+static std::size_t s_Failures = 0;
+
+static void ExpectAllocations(const char *name, std::size_t allocations, std::size_t limit) {
+	Println("%: % allocations (at most %), %", name, allocations, limit, allocations > limit ? "FAILED" : "ok");
+
+	s_Failures += allocations > limit;
+}
+
+//steady state is expected to stay off the heap
+static void ExpectNoAllocations(const char *name, std::size_t allocations) {
+	ExpectAllocations(name, allocations, 0);
+}
+
+static void BenchmarkAgentIterate(const Environment &env) {
+	const float dt = 1.f / 60;
+
+	VacuumCleanerOperator agent;
+	agent.Reset(env, sf::Vector2f(env.StartPosition));
+
+	//workspaces grow on first use
+	for (std::size_t i = 0; i < 10; i++)
+		agent.Iterate(env, dt, i);
+
+	ExpectNoAllocations("1000 x VacuumCleanerOperator::Iterate", AllocationCounter::Measure([&]() {
+		for (std::size_t i = 0; i < 1000; i++)
+			agent.Iterate(env, dt, i);
+	}));
+}
+
+static void BenchmarkInference() {
+	NeuralNetworkAgent agent((int)CleanerSensorsCount);
+	const NeuralNetwork &network = agent.Network();
+
+	InferenceWorkspace workspace(network.Topology());
+	const Matrix<float> input = Matrix<float>::Random(1, network.Topology().front(), -1, 1);
+	Matrix<float> output;
+	network.Do(input, output, workspace);
+
+	//value version allocates every temporary on its own
+	const bool exact = network.Do(input) == output;
+	Println("NeuralNetwork::Do with workspace is bit exact: %", exact);
+	s_Failures += !exact;
+
+	ExpectNoAllocations("1000 x NeuralNetwork::Do with workspace", AllocationCounter::Measure([&]() {
+		for (std::size_t i = 0; i < 1000; i++)
+			network.Do(input, output, workspace);
+	}));
+}
+
+//value versions of genetic operators allocate only their results, small matrices are inline.
+//First calls also grow random scratch buffers, so limits hold for any order
+static void BenchmarkGeneticOperators() {
+	NeuralNetworkAgent first((int)CleanerSensorsCount);
+	NeuralNetworkAgent second((int)CleanerSensorsCount);
+
+	//32 x 20 weights with 20 biases, bias row fits inline
+	const Layer &layer1 = first.Network().Layers()[1];
+	const Layer &layer2 = second.Network().Layers()[1];
+
+	ExpectAllocations("Layer::Crossover + Layer::MutateLayer", AllocationCounter::Measure([&]() {
+		Layer::MutateLayer(Layer::Crossover(layer1, layer2), 0.5f, 1.f);
+	}), 4);
+
+	ExpectAllocations("NeuralNetwork::Crossover + NeuralNetwork::MutateNetwork", AllocationCounter::Measure([&]() {
+		NeuralNetwork::MutateNetwork(NeuralNetwork::Crossover(first.Network(), second.Network()), 0.5f, 1.f);
+	}), 16);
+}
+
+//real training from a fixed seed, pool of recycled operators and every buffer are full after a few generations.
+//Generation logs its lines, formatting them may allocate, operators themselves may not
+static void BenchmarkTraining(Environment &env) {
+	const auto directory = std::filesystem::temp_directory_path();
+	const std::string map_path = (directory / "allocation_benchmark.map").string();
+	const std::string best_path = (directory / "allocation_benchmark.mod").string();
+
+	env.SaveToFile(map_path);
+	std::filesystem::remove(best_path);
+	RandomGenerator::SetSeed(RandomGenerator::DefaultSeed);
+
+	{
+		EvolutionTraining training(best_path, map_path);
+		training.SetThreadsCount(1);
+
+		while (training.Generation() < 3)
+			training.Tick(1.f / 60);
+
+		for (std::size_t i = 0; i < 3; i++) {
+			const std::size_t allocations = AllocationCounter::Measure([&]() {
+				training.NextGeneration();
+			});
+
+			const std::string name = "EvolutionTraining::NextGeneration of " + std::to_string(training.Population().size()) + " operators";
+
+			if(i == 0)
+				Println("%: % allocations, warm-up", name, allocations);
+			else
+				ExpectAllocations(name.c_str(), allocations, 4);
+		}
+
+		//generation does not change, so only agents steps are measured
+		ExpectNoAllocations("100 x EvolutionTraining::Tick", AllocationCounter::Measure([&]() {
+			for (std::size_t i = 0; i < 100; i++)
+				training.Tick(1.f / 60);
+		}));
+	}
+
+	std::filesystem::remove(map_path);
+	std::filesystem::remove(best_path);
+}
+
+int main() {
+	Environment env;
+	MakeBenchmarkRoom(env);
+
+	BenchmarkAgentIterate(env);
+	BenchmarkInference();
+	BenchmarkGeneticOperators();
+	BenchmarkTraining(env);
+
+	return s_Failures ? 1 : 0;
+}
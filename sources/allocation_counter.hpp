@@ -0,0 +1,65 @@
+#pragma once
+
+#include <new>
+#include <atomic>
+#include <cstdlib>
+#include <cstddef>
+
+//Replaces global operator new with a counting one for allocation benchmarks.
+//Replacements can't be inline, so only one translation unit of an executable includes this
+namespace AllocationCounter {
+	inline std::atomic<std::size_t> &Counter() {
+		static std::atomic<std::size_t> counter{0};
+		return counter;
+	}
+
+	inline std::size_t Count() {
+		return Counter().load();
+	}
+
+	//heap allocations made by function on any thread
+	template<typename FunctionType>
+	std::size_t Measure(FunctionType function) {
+		const std::size_t begin = Count();
+		function();
+		return Count() - begin;
+	}
+}
+
+void *operator new(std::size_t size) {
+	AllocationCounter::Counter()++;
+
+	if(void *pointer = std::malloc(size ? size : 1))
+		return pointer;
+
+	throw std::bad_alloc();
+}
+
+void *operator new(std::size_t size, std::align_val_t alignment) {
+	AllocationCounter::Counter()++;
+
+	const std::size_t align = std::size_t(alignment);
+	//aligned_alloc wants size to be a multiple of alignment
+	const std::size_t padded = (size + align - 1) / align * align;
+#ifdef _WIN32
+	void *pointer = _aligned_malloc(padded ? padded : align, align);
+#else
+	void *pointer = std::aligned_alloc(align, padded ? padded : align);
+#endif
+	if(pointer)
+		return pointer;
+
+	throw std::bad_alloc();
+}
+
+void operator delete(void *pointer)noexcept {
+	std::free(pointer);
+}
+
+void operator delete(void *pointer, std::align_val_t)noexcept {
+#ifdef _WIN32
+	_aligned_free(pointer);
+#else
+	std::free(pointer);
+#endif
+}
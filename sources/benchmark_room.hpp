@@ -0,0 +1,25 @@
+#pragma once
+
+#include "env/environment.hpp"
+
+//square room with a zig-zag path, enough for agents to sense walls and follow goals
+inline void MakeBenchmarkRoom(Environment &env) {
+	const int size = 1000;
+
+	env.Walls = {
+		{{0, 0}, {size, 0}},
+		{{size, 0}, {size, size}},
+		{{size, size}, {0, size}},
+		{{0, size}, {0, 0}},
+		{{size / 2, size / 4}, {size / 2, size * 3 / 4}}
+	};
+
+	for (int y = 100; y < size; y += 200) {
+		env.Path.push_back({100, y});
+		env.Path.push_back({size - 100, y});
+	}
+
+	env.StartPosition = {size / 4, size / 2};
+	env.RebuildWallsBVH();
+	env.RebuildWallsSDF();
+}
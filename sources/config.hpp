@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <SFML/System/Vector2.hpp>
 
 constexpr float Eps = 0.001;
@@ -8,6 +9,7 @@ constexpr float PointRadius = 5.f;
 
 constexpr float CleanerRadius = 30.f;
 constexpr float CleanerRayLength = 40;
+constexpr std::size_t CleanerSensorsCount = 6;
 static sf::Vector2f CleanerSpeed(60, 60);
 
 constexpr float MutationChance = 0.5;
@@ -24,3 +26,6 @@ constexpr size_t BestModelsToMutationChance = 0.5;
 constexpr size_t BestModelsMutateTimes = 10;
 constexpr size_t RandomCrossovers = 3;
 constexpr size_t ModelsToSave = 30;
+
+//threads simulating the population, 0 uses every hardware thread
+constexpr size_t EvolutionThreads = 0;
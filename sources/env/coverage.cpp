@@ -218,7 +218,7 @@ bool CoverageDecomposition::HasAnyOccupied(sf::Vector2i coverage)const {
 }
 
 bool CoverageDecomposition::IsComplex(sf::Vector2i coverage) const{
-	return LocatedVisitPointsCache[coverage].size() > 1 || HasAnyOccupied(coverage);
+	return LocatedVisitPoints(coverage).size() > 1 || HasAnyOccupied(coverage);
 }
 
 bool IsInAny(const std::vector<sf::IntRect>& rects, sf::Vector2i point) {
@@ -299,7 +299,7 @@ std::vector<sf::Vector2i> CoverageDecomposition::GatherCoverageVisitPointsInRadi
 
 	for (int x = start.x; x <= end.x; x++) {
 		for (int y = start.y; y <= end.y; y++) {
-			auto points = LocatedVisitPointsCache[{x, y}];
+			const auto &points = LocatedVisitPoints({x, y});
 
 			std::copy(points.begin(), points.end(), std::back_inserter(result));
 		}				
@@ -311,7 +311,7 @@ std::vector<sf::Vector2i> CoverageDecomposition::GatherCoverageVisitPointsInRadi
 std::vector<sf::Vector2i> CoverageDecomposition::GatherNeighboursVisitPoints(sf::Vector2i coverage_cell) const{
 	auto neighbours = GatherCoverageVisitPointsInRadius(coverage_cell, {2, 2});
 	
-	auto actual = LocatedVisitPointsCache[coverage_cell];
+	const auto &actual = LocatedVisitPoints(coverage_cell);
 
 	for (auto point : actual) {
 		auto it = std::remove(neighbours.begin(), neighbours.end(), point);
@@ -344,7 +344,7 @@ std::optional<sf::Vector2i> CoverageDecomposition::LocalNearestVisitPointTo(sf::
 
 	auto coverage = GridToCoverageCell(cell);
 
-	auto visit = LocatedVisitPointsCache[coverage];
+	const auto &visit = LocatedVisitPoints(coverage);
 
 	return visit.size() ? std::optional<sf::Vector2i>{visit.front()} : std::nullopt;
 }
@@ -593,3 +593,11 @@ std::vector<sf::Vector2i> CoverageDecomposition::SimplePathAlgorithm(sf::Vector2
 	
 	return path;
 }
+
+const std::vector<sf::Vector2i>& CoverageDecomposition::LocatedVisitPoints(sf::Vector2i coverage_cell) const{
+	static const std::vector<sf::Vector2i> Empty;
+
+	auto it = LocatedVisitPointsCache.find(coverage_cell);
+
+	return it != LocatedVisitPointsCache.end() ? it->second : Empty;
+}
@@ -59,6 +59,9 @@ struct CoverageDecomposition {
 	//Visit points are in world_local
 	std::vector<sf::Vector2i> MakeVisitPoints(sf::Vector2i coverage_cell)const;
 
+	//read only lookup into LocatedVisitPointsCache, safe to call from several threads
+	const std::vector<sf::Vector2i> &LocatedVisitPoints(sf::Vector2i coverage_cell)const;
+
 	std::vector<sf::Vector2i> MakeVisitPoints()const;
 
 	std::vector<sf::Vector2i> GatherCoverageVisitPoints(sf::Vector2i coverage_cell)const;
@@ -38,6 +38,13 @@ void Environment::Draw(sf::RenderTarget& rt, std::size_t path_drawing_mode, bool
 	Render::DrawString(rt, StartPosition - sf::Vector2i(0, PointRadius), "Start");
 	Render::DrawCircle(rt, StartPosition, PointRadius, sf::Color::Cyan);
 
+	for (int i = 0; i < AdditionalStartPositions.size(); i++) {
+		auto start = AdditionalStartPositions[i];
+
+		Render::DrawString(rt, start - sf::Vector2i(0, PointRadius), "Start " + std::to_string(i + 1));
+		Render::DrawCircle(rt, start, PointRadius, sf::Color::Cyan);
+	}
+
 	if(path_drawing_mode == PathWithPoints){
 		for (int i = 0; i<Path.size(); i++) {
 			auto point = Path[i];
@@ -172,6 +179,7 @@ void Environment::SaveToFile(const std::string& filename) {
 	Serializer<std::vector<Wall>>::ToStream(Walls, file);
 	Serializer<std::vector<sf::IntRect>>::ToStream(ZonesToClean, file);
 	Serializer<sf::Vector2i>::ToStream(StartPosition, file);
+	Serializer<std::vector<sf::Vector2i>>::ToStream(AdditionalStartPositions, file);
 }
 
 void Environment::LoadFromFile(const std::string& filename) {
@@ -183,6 +191,7 @@ void Environment::LoadFromFile(const std::string& filename) {
 	auto walls = Serializer<std::vector<Wall>>::FromStream(file);
 	auto zones = Serializer<std::vector<sf::IntRect>>::FromStream(file);
 	auto start = Serializer<sf::Vector2i>::FromStream(file);
+	auto additional_starts = Serializer<std::vector<sf::Vector2i>>::FromStream(file);
 
 	if(!path.has_value() || !walls.has_value())
 		return;
@@ -193,6 +202,10 @@ void Environment::LoadFromFile(const std::string& filename) {
 		ZonesToClean = std::move(zones.value());
 
 	StartPosition = start.value_or(sf::Vector2i(0, 0));
+
+	RebuildWallsBVH();
+	RebuildWallsSDF();
+	AdditionalStartPositions = additional_starts.value_or(std::vector<sf::Vector2i>());
 }
 
 void Environment::Bake(std::size_t cell_size, bool optimized_graph) {
@@ -215,6 +228,12 @@ void Environment::Bake(std::size_t cell_size, bool optimized_graph) {
 		CoverageGraph = Graph::MakeFrom(Coverage);
 
 	LogEnv(Info, "Graph took % seconds", cl.restart().asSeconds());
+
+	RebuildWallsBVH();
+	LogEnv(Info, "Walls BVH took % seconds", cl.restart().asSeconds());
+
+	RebuildWallsSDF();
+	LogEnv(Info, "Walls SDF took % seconds", cl.restart().asSeconds());
 }
 
 sf::Vector2i Min(sf::Vector2i first, sf::Vector2i second) {
@@ -244,3 +263,134 @@ sf::IntRect Environment::GatherBounds()const {
 
 	return {min, max - min};
 }
+
+void Environment::RebuildWallsBVH() {
+	WallsBVH = WallBVH(Walls);
+	WallsTable = WallTable(Walls);
+}
+
+void Environment::InvalidateWallsAccelerators() {
+	WallsBVH = WallBVH();
+	WallsTable = WallTable();
+	WallsSDF = WallSDF();
+}
+
+bool Environment::CanUseWallsBVH()const {
+	//edits invalidate accelerators, count only guards against Walls changed without that
+	return UseWallsBVH && WallsBVH.WallsCount() == Walls.size();
+}
+
+void Environment::RebuildWallsSDF() {
+	if (!Walls.size()) {
+		WallsSDF = WallSDF();
+		return;
+	}
+
+	//does not depend on baked grid, training loads maps without baking
+	sf::Vector2i min = Walls.front().Start;
+	sf::Vector2i max = Walls.front().Start;
+
+	for (const auto &wall : Walls) {
+		min = Min(Min(min, wall.Start), wall.End);
+		max = Max(Max(max, wall.Start), wall.End);
+	}
+
+	sf::Vector2f margin(CleanerRadius * 2, CleanerRadius * 2);
+	sf::Vector2f position = sf::Vector2f(min) - margin;
+
+	WallsSDF = WallSDF(Walls, {position, sf::Vector2f(max) + margin - position}, WallsSDFResolution);
+}
+
+bool Environment::CanUseWallsSDF()const {
+	return WallsSDF.WallsCount() == Walls.size() && !WallsSDF.IsEmpty();
+}
+
+bool Environment::IsCrashed(sf::Vector2f position)const {
+	if (UseWallsSDFCrashes && CanUseWallsSDF()) {
+		//interpolated distance is off by up to ErrorBound in either direction
+		const float distance = WallsSDF.Distance(position);
+		const float bound = WallsSDF.ErrorBound();
+
+		if(distance > CleanerRadius + bound)
+			return false;
+
+		if(distance < CleanerRadius - bound)
+			return true;
+	}
+
+	for (const auto &wall : Walls) {
+		if(Math::LineCircleIntersection(sf::Vector2f(wall.Start), sf::Vector2f(wall.End), position, CleanerRadius))
+			return true;
+	}
+	return false;
+}
+
+float Environment::TraceNearestObstacle(sf::Vector2f position, sf::Vector2f direction)const {
+	if(UseWallsSDFSensors && CanUseWallsSDF())
+		return TraceNearestObstacleWithNormal(position, direction).first;
+
+	if(CanUseWallsBVH() && Walls.size() <= MaxWallsTableSize)
+		return WallsTable.TraceNearestObstacle(position, direction);
+
+	if(CanUseWallsBVH())
+		return WallsBVH.TraceNearestObstacle(position, direction);
+
+	return Wall::TraceNearestObstacle(position, direction, Walls);
+}
+
+std::pair<float, sf::Vector2f> Environment::TraceNearestObstacleWithNormal(sf::Vector2f position, sf::Vector2f direction)const {
+	if (UseWallsSDFSensors && CanUseWallsSDF()) {
+		return WallsSDF.SphereTrace(position, direction, [this](sf::Vector2f position, sf::Vector2f direction) {
+			return TraceWallsWithNormal(position, direction);
+		});
+	}
+
+	return TraceWallsWithNormal(position, direction);
+}
+
+std::pair<float, sf::Vector2f> Environment::TraceWallsWithNormal(sf::Vector2f position, sf::Vector2f direction)const {
+	if(CanUseWallsBVH() && Walls.size() <= MaxWallsTableSize)
+		return WallsTable.TraceNearestObstacleWithNormal(position, direction);
+
+	if(CanUseWallsBVH())
+		return WallsBVH.TraceNearestObstacleWithNormal(position, direction);
+
+	return Wall::TraceNearestObstacleWithNormal(position, direction, Walls);
+}
+
+std::pair<float, sf::Vector2f> Environment::TraceNearestObstacleWithNormal(sf::Vector2f position, sf::Vector2f direction, std::int32_t &hint_wall)const {
+	if(CanUseSensorsCache())
+		return WallsBVH.TraceNearestObstacleWithNormal(position, direction, hint_wall);
+
+	return TraceNearestObstacleWithNormal(position, direction);
+}
+
+bool Environment::CanUseSensorsCache()const {
+	//SIMD table scan is cheaper than any pruning on small maps
+	return UseSensorsCache && !UseWallsSDFSensors && CanUseWallsBVH() && Walls.size() > MaxWallsTableSize;
+}
+
+std::size_t Environment::TraceNearestObstaclesWithNormal(const sf::Vector2f *positions, const sf::Vector2f *directions, std::size_t count, float *distances, sf::Vector2f *normals, std::int32_t *hints)const {
+	if (hints && CanUseSensorsCache()) {
+		std::size_t cache_hits = 0;
+
+		for (std::size_t i = 0; i < count; i++) {
+			std::int32_t hint = hints[i];
+			std::tie(distances[i], normals[i]) = WallsBVH.TraceNearestObstacleWithNormal(positions[i], directions[i], hints[i]);
+			cache_hits += hint >= 0 && hint == hints[i];
+		}
+
+		return cache_hits;
+	}
+
+	if (!UseWallsSDFSensors && CanUseWallsBVH() && Walls.size() <= MaxWallsTableSize) {
+		WallsTable.TraceNearestObstaclesWithNormal(positions, directions, count, distances, normals);
+		return 0;
+	}
+
+	for (std::size_t i = 0; i < count; i++) {
+		std::tie(distances[i], normals[i]) = TraceNearestObstacleWithNormal(positions[i], directions[i]);
+	}
+
+	return 0;
+}
@@ -9,6 +9,9 @@
 #include "env/grid.hpp"
 #include "env/coverage.hpp"
 #include "env/graph.hpp"
+#include "env/wall_bvh.hpp"
+#include "env/wall_table.hpp"
+#include "env/wall_sdf.hpp"
 #include "config.hpp"
 
 struct Environment {
@@ -16,11 +19,30 @@ struct Environment {
 	std::vector<Wall> Walls;
 	sf::Vector2i StartPosition;
 	std::vector<sf::IntRect> ZonesToClean;
+	//for multi robot cleaning, StartPosition is always the first robot
+	std::vector<sf::Vector2i> AdditionalStartPositions;
 	
 	GridDecomposition Grid;
 	CoverageDecomposition Coverage{Grid};
 	Graph CoverageGraph;
 
+	//rebuilt on load and bake, brute force is used while walls are being edited
+	WallBVH WallsBVH;
+	bool UseWallsBVH = true;
+	//flat SIMD scan beats BVH traversal on small maps
+	WallTable WallsTable;
+	static constexpr std::size_t MaxWallsTableSize = 256;
+
+	//rebuilt on load and bake with WallsSDFResolution, see WallSDF::ErrorBound
+	WallSDF WallsSDF;
+	float WallsSDFResolution = 8.f;
+	//SDF only settles crashes farther than ErrorBound from CleanerRadius, exact test decides the rest
+	bool UseWallsSDFCrashes = false;
+	//SDF skips empty space and exact trace finishes near walls, results are exact, see WallSDFError::SkippedFraction
+	bool UseWallsSDFSensors = false;
+	//rays traced every tick remember their last hit wall, only BVH traversal can benefit from it
+	bool UseSensorsCache = true;
+
 	std::size_t CoverageSize = 4;
 	sf::Vector2i FrameSize;
 
@@ -58,6 +80,36 @@ struct Environment {
 
 	sf::IntRect GatherBounds()const;
 
+	void RebuildWallsBVH();
+
+	//should be called on every edit of Walls, queries go brute force until the next rebuild
+	void InvalidateWallsAccelerators();
+
+	bool CanUseWallsBVH()const;
+
+	void RebuildWallsSDF();
+
+	bool CanUseWallsSDF()const;
+
+	//cleaner of CleanerRadius at position touches any wall
+	bool IsCrashed(sf::Vector2f position)const;
+
+	float TraceNearestObstacle(sf::Vector2f position, sf::Vector2f direction)const;
+
+	std::pair<float, sf::Vector2f> TraceNearestObstacleWithNormal(sf::Vector2f position, sf::Vector2f direction)const;
+
+	//exact trace with table, BVH or plain walls, what SDF sensors finish with
+	std::pair<float, sf::Vector2f> TraceWallsWithNormal(sf::Vector2f position, sf::Vector2f direction)const;
+
+	//hint_wall is the wall this ray hit last time, it is updated in place and never changes the result
+	std::pair<float, sf::Vector2f> TraceNearestObstacleWithNormal(sf::Vector2f position, sf::Vector2f direction, std::int32_t &hint_wall)const;
+
+	bool CanUseSensorsCache()const;
+
+	//traces count rays in one go, results are written into distances and normals arrays.
+	//hints are optional, one per ray, returns how many rays hit their hinted wall again
+	std::size_t TraceNearestObstaclesWithNormal(const sf::Vector2f *positions, const sf::Vector2f *directions, std::size_t count, float *distances, sf::Vector2f *normals, std::int32_t *hints = nullptr)const;
+
 	sf::Vector2i LocalStartPosition()const {
 		return StartPosition - Grid.Bounds.getPosition();
 	}
@@ -66,6 +118,12 @@ struct Environment {
 		return Coverage.LocalNearestVisitPointTo(LocalStartPosition());
 	}
 
+	std::vector<sf::Vector2i> StartPositions()const {
+		std::vector<sf::Vector2i> starts{StartPosition};
+		std::copy(AdditionalStartPositions.begin(), AdditionalStartPositions.end(), std::back_inserter(starts));
+		return starts;
+	}
+
 	std::optional<sf::Vector2i> LocalNearestTo(sf::Vector2i point)const {
 		return Coverage.LocalNearestVisitPointTo(point);
 	}
@@ -76,6 +134,8 @@ struct Environment {
 		Path.clear();
 		Grid.Clear();
 		ZonesToClean.clear();
+		AdditionalStartPositions.clear();
+		InvalidateWallsAccelerators();
 		Coverage.Rebuild();
 	}
 };
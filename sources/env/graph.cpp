@@ -113,6 +113,104 @@ std::vector<sf::Vector2i> Graph::ShortestPath(sf::Vector2i src, sf::Vector2i dst
     return path;
 }
 
+std::vector<sf::Vector2i> Graph::FastestPath(sf::Vector2i src, sf::Vector2i dst, std::optional<sf::Vector2f> heading, int heading_bins) const {
+	const float BinAngle = 360.f / heading_bins;
+	//heading is unknown, first rotation is free
+	const int NoHeading = heading_bins;
+
+	auto ToBin = [&](sf::Vector2f direction) -> int {
+		float angle = std::atan2(direction.y, direction.x) * 180.f / 3.14159265f;
+		int bin = (int)std::lround(angle / BinAngle) % heading_bins;
+		return bin < 0 ? bin + heading_bins : bin;
+	};
+
+	auto TurnTime = [&](int from, int to) -> float {
+		if(from == NoHeading)
+			return 0.f;
+
+		int difference = std::abs(from - to) % heading_bins;
+		return CleanerKinematics::TurnTime(std::min(difference, heading_bins - difference) * BinAngle);
+	};
+
+	auto Heuristic = [](sf::Vector2i a, sf::Vector2i b) -> float {
+		return CleanerKinematics::MoveTime(sf::Vector2f(b - a).length());
+	};
+
+	struct State {
+		sf::Vector2i Vertex;
+		int Heading = 0;
+
+		bool operator==(const State& other)const {
+			return Vertex == other.Vertex && Heading == other.Heading;
+		}
+	};
+
+	struct StateHash {
+		std::size_t operator()(const State& state)const {
+			return std::hash<sf::Vector2i>()(state.Vertex) * 31 + state.Heading;
+		}
+	};
+
+	std::unordered_map<State, State, StateHash> came_from;
+	std::unordered_map<State, float, StateHash> cost_so_far;
+
+	auto compare = [](const std::pair<State, float>& a, const std::pair<State, float>& b) {
+		return a.second > b.second;
+	};
+	std::priority_queue<
+		std::pair<State, float>,
+		std::vector<std::pair<State, float>>,
+		decltype(compare)
+	> frontier(compare);
+
+	State start{src, heading.has_value() && heading->length() > Eps ? ToBin(heading.value()) : NoHeading};
+
+	frontier.emplace(start, 0.f);
+	came_from[start] = start;
+	cost_so_far[start] = 0.f;
+
+	std::optional<State> end;
+
+	while (!frontier.empty()) {
+		State current = frontier.top().first;
+		frontier.pop();
+
+		if (current.Vertex == dst) {
+			end = current;
+			break;
+		}
+
+		for (const auto& next_vertex : m_Vertices[current.Vertex].Neighbours) {
+			auto direction = sf::Vector2f(next_vertex - current.Vertex);
+
+			if(direction.length() < Eps)
+				continue;
+
+			State next{next_vertex, ToBin(direction)};
+			float new_cost = cost_so_far[current] + TurnTime(current.Heading, next.Heading) + CleanerKinematics::MoveTime(direction.length());
+
+			auto it = cost_so_far.find(next);
+			if (it == cost_so_far.end() || new_cost < it->second) {
+				cost_so_far[next] = new_cost;
+				frontier.emplace(next, new_cost + Heuristic(next_vertex, dst));
+				came_from[next] = current;
+			}
+		}
+	}
+
+	std::vector<sf::Vector2i> path;
+	if (!end.has_value()) {
+		return path; // No path found
+	}
+
+	for (State current = end.value(); !(current == start); current = came_from[current]) {
+		path.push_back(current.Vertex);
+	}
+	path.push_back(src);
+	std::reverse(path.begin(), path.end());
+	return path;
+}
+
 std::size_t Graph::CountReachableFrom(sf::Vector2i src) const{
     std::queue<sf::Vector2i> frontier;
     std::unordered_set<sf::Vector2i, std::hash<sf::Vector2i>> visited;
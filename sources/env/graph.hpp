@@ -1,8 +1,17 @@
 #pragma once
 
 #include "env/coverage.hpp"
+#include <cmath>
 #include <unordered_map>
 #include <SFML/Graphics/RenderTarget.hpp>
+#include "config.hpp"
+
+//Cleaner rotates in place and then moves forward, see VacuumCleaner::Move
+struct CleanerKinematics {
+	static float MoveTime(float distance){ return distance / CleanerSpeed.x; }
+
+	static float TurnTime(float degrees){ return std::abs(degrees) / CleanerSpeed.y; }
+};
 
 struct SortByDirection {
 	sf::Vector2i Direction;
@@ -69,10 +78,17 @@ public:
 	void DrawVertex(sf::RenderTarget &rt, sf::Vector2i vertex, sf::Vector2i offset = {0, 0}, bool draw_directions = false)const;
 	
 	std::vector<sf::Vector2i> ShortestPath(sf::Vector2i src, sf::Vector2i dst)const;
+
+	//Same as ShortestPath, but minimizes travel time including rotations, searches over (vertex, quantized heading)
+	std::vector<sf::Vector2i> FastestPath(sf::Vector2i src, sf::Vector2i dst, std::optional<sf::Vector2f> heading = {}, int heading_bins = 16)const;
 	
 	template<typename PredicateType>
 	std::optional<sf::Vector2i> BreadthSearchByPredicate(sf::Vector2i src, PredicateType predicate)const;
 
+	//keeps only vertices matching predicate and connections between them
+	template<typename PredicateType>
+	Graph Subgraph(PredicateType predicate)const;
+
 	std::size_t CountReachableFrom(sf::Vector2i src)const;
 
 	std::size_t Size()const {
@@ -110,3 +126,23 @@ inline std::optional<sf::Vector2i> Graph::BreadthSearchByPredicate(sf::Vector2i
 	}
 	return std::nullopt;
 }
+
+template<typename PredicateType>
+inline Graph Graph::Subgraph(PredicateType predicate) const{
+	std::unordered_map<sf::Vector2i, Neighbours> result;
+
+	for (const auto& [vertex, neighbours] : m_Vertices) {
+		if(!predicate(vertex))
+			continue;
+
+		auto &copy = result[vertex];
+		copy.HasAnyOccupied = neighbours.HasAnyOccupied;
+
+		for (auto neighbour : neighbours.Neighbours) {
+			if(predicate(neighbour))
+				copy.Neighbours.push_back(neighbour);
+		}
+	}
+
+	return {std::move(result)};
+}
@@ -0,0 +1,189 @@
+#include "multi_robot.hpp"
+#include <queue>
+#include <future>
+#include <algorithm>
+#include "bsl/log.hpp"
+#include "utils/math.hpp"
+
+DEFINE_LOG_CATEGORY(MultiRobot)
+
+MultiRobotPlanner::MultiRobotPlanner(const Environment& env):
+	m_Env(env)
+{}
+
+float MultiRobotPlanner::VertexCost(sf::Vector2i local_vertex, sf::Vector2i from, sf::Vector2f heading)const {
+	const auto &coverage = m_Env.Coverage;
+	const auto direction = sf::Vector2f(local_vertex - from);
+
+	float cost = CleanerKinematics::MoveTime(direction.length());
+
+	if(direction.length() > Eps && heading.length() > Eps)
+		cost += CleanerKinematics::TurnTime(Math::AngleSigned(heading, direction));
+
+	auto coverage_cell = coverage.GridToCoverageCell(m_Env.Grid.LocalPositionToCellIndex(local_vertex));
+
+	for (auto zone : coverage.SimpleZoneDecompositionCache) {
+		if(zone.contains(coverage_cell))
+			return cost;
+	}
+
+	return cost * ComplexVertexCost;
+}
+
+std::vector<std::optional<sf::Vector2i>> MultiRobotPlanner::Seeds(const std::vector<sf::Vector2i>& starts)const {
+	std::vector<std::optional<sf::Vector2i>> seeds;
+
+	auto IsTaken = [&seeds](sf::Vector2i vertex) {
+		return std::find(seeds.begin(), seeds.end(), std::make_optional(vertex)) != seeds.end();
+	};
+
+	for (std::size_t i = 0; i < starts.size(); i++) {
+		auto seed = m_Env.LocalNearestTo(starts[i] - m_Env.Grid.Bounds.getPosition());
+
+		if (!seed.has_value()) {
+			LogMultiRobot(Warning, "Start % is not near any coverage vertex", i);
+		} else if (IsTaken(seed.value())) {
+			//robot drives through the region of the other one to its own
+			seed = m_Env.CoverageGraph.BreadthSearchByPredicate(seed.value(), [&IsTaken](sf::Vector2i vertex) {
+				return !IsTaken(vertex);
+			});
+
+			LogMultiRobotIf(!seed.has_value(), Warning, "Start % has no free coverage vertex", i);
+		}
+
+		seeds.push_back(seed);
+	}
+
+	return seeds;
+}
+
+MultiRobotPartition MultiRobotPlanner::Partition(const std::vector<sf::Vector2i>& starts)const {
+	const auto &graph = m_Env.CoverageGraph;
+
+	//heading is the direction robot arrives to from with
+	struct FrontierVertex {
+		sf::Vector2i Vertex;
+		sf::Vector2i From;
+		sf::Vector2f Heading;
+	};
+
+	MultiRobotPartition partition;
+	partition.Seeds = Seeds(starts);
+	partition.Costs.resize(starts.size(), 0.f);
+
+	std::vector<std::queue<FrontierVertex>> frontiers(starts.size());
+
+	for (std::size_t i = 0; i < starts.size(); i++) {
+		if(!partition.Seeds[i].has_value())
+			continue;
+
+		const sf::Vector2i local_start = starts[i] - m_Env.Grid.Bounds.getPosition();
+		const sf::Vector2i seed = partition.Seeds[i].value();
+
+		frontiers[i].push({seed, local_start, {}});
+	}
+
+	using Entry = std::pair<float, std::size_t>;
+	std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> regions;
+
+	for (std::size_t i = 0; i < starts.size(); i++) {
+		if(frontiers[i].size())
+			regions.emplace(0.f, i);
+	}
+
+	while (regions.size()) {
+		auto region = regions.top().second;
+		regions.pop();
+
+		auto &frontier = frontiers[region];
+
+		while (frontier.size()) {
+			auto [vertex, from, heading] = frontier.front();
+			frontier.pop();
+
+			if(partition.RegionOf.count(vertex))
+				continue;
+
+			partition.RegionOf[vertex] = region;
+			partition.Costs[region] += VertexCost(vertex, from, heading);
+
+			const auto direction = sf::Vector2f(vertex - from);
+
+			for (auto neighbour : graph[vertex].Neighbours) {
+				if(!partition.RegionOf.count(neighbour))
+					frontier.push({neighbour, vertex, direction.length() > Eps ? direction : heading});
+			}
+			break;
+		}
+
+		if(frontier.size())
+			regions.emplace(partition.Costs[region], region);
+	}
+
+	return partition;
+}
+
+MultiRobotPlan MultiRobotPlanner::MakePlan(const PathBuilder& builder, const std::vector<sf::Vector2i>& starts)const {
+	MultiRobotPlan plan;
+
+	auto partition = Partition(starts);
+	const auto &region_of = partition.RegionOf;
+
+	plan.RegionCosts = partition.Costs;
+
+	//m_Env is shared by all tasks, only the region graph is per robot
+	std::vector<Graph> regions;
+	regions.reserve(starts.size());
+
+	for (std::size_t i = 0; i < starts.size(); i++) {
+		regions.push_back(m_Env.CoverageGraph.Subgraph([&region_of, i](sf::Vector2i vertex) {
+			auto it = region_of.find(vertex);
+			return it != region_of.end() && it->second == i;
+		}));
+	}
+
+	//robots seeded away from their nearest vertex drive to the seed first, paths are found before tasks
+	//start because the shared graph is not safe to search from many threads
+	std::vector<std::vector<sf::Vector2i>> transits(starts.size());
+
+	for (std::size_t i = 0; i < starts.size(); i++) {
+		const sf::Vector2i local_start = starts[i] - m_Env.Grid.Bounds.getPosition();
+		const auto nearest = m_Env.LocalNearestTo(local_start);
+		const auto &seed = partition.Seeds[i];
+
+		if(seed.has_value() && nearest.has_value() && seed != nearest)
+			transits[i] = m_Env.CoverageGraph.FastestPath(nearest.value(), seed.value());
+	}
+
+	std::vector<std::future<std::vector<sf::Vector2i>>> tasks;
+
+	for (std::size_t i = 0; i < starts.size(); i++) {
+		const sf::Vector2i local_start = starts[i] - m_Env.Grid.Bounds.getPosition();
+		const sf::Vector2i from = transits[i].size() ? transits[i].back() : local_start;
+
+		tasks.push_back(std::async(std::launch::async, [this, &builder, &region = regions[i], from]() {
+			return builder.MakePath(m_Env, region, from);
+		}));
+	}
+
+	for (std::size_t i = 0; i < tasks.size(); i++) {
+		auto path = tasks[i].get();
+
+		//path from the seed begins with the seed twice, it goes after the start and the transit instead
+		if (transits[i].size() && path.size() >= 2) {
+			std::vector<sf::Vector2i> full{starts[i] - m_Env.Grid.Bounds.getPosition()};
+			full.insert(full.end(), transits[i].begin(), transits[i].end());
+			full.insert(full.end(), path.begin() + 2, path.end());
+			path = std::move(full);
+		}
+
+		for (auto &point : path)
+			point += m_Env.Grid.Bounds.getPosition();
+
+		plan.PathTimes.push_back(EstimatePathTime(path));
+		plan.Makespan = std::max(plan.Makespan, plan.PathTimes.back());
+		plan.Paths.push_back(std::move(path));
+	}
+
+	return plan;
+}
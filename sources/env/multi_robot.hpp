@@ -0,0 +1,49 @@
+#pragma once
+
+#include <vector>
+#include <optional>
+#include <unordered_map>
+#include "env/path.hpp"
+
+struct MultiRobotPlan {
+	//in world space, one per start position
+	std::vector<std::vector<sf::Vector2i>> Paths;
+	//estimated cleaning time of each region and of each built path
+	std::vector<float> RegionCosts;
+	std::vector<float> PathTimes;
+	//time until the last robot finishes
+	float Makespan = 0.f;
+};
+
+struct MultiRobotPartition {
+	//region index for every reachable local vertex
+	std::unordered_map<sf::Vector2i, std::size_t> RegionOf;
+	//local vertex each region grows from, nullopt when start has no free vertex
+	std::vector<std::optional<sf::Vector2i>> Seeds;
+	//estimated cleaning time of each region
+	std::vector<float> Costs;
+};
+
+//Splits coverage graph into connected regions of similar cleaning time, one per start position
+class MultiRobotPlanner {
+	const Environment &m_Env;
+public:
+	//cost multiplier for vertices outside of simple zones, they are cleaned with extra maneuvers near walls
+	float ComplexVertexCost = 1.5f;
+
+	MultiRobotPlanner(const Environment &env);
+
+	//starts are in world space, the cheapest region grows first so regions stay balanced and connected
+	MultiRobotPartition Partition(const std::vector<sf::Vector2i> &starts)const;
+
+	//vertex nearest to every start, starts snapped to a taken vertex get the nearest free one by graph
+	std::vector<std::optional<sf::Vector2i>> Seeds(const std::vector<sf::Vector2i> &starts)const;
+
+	//runs builder for each region in parallel
+	MultiRobotPlan MakePlan(const PathBuilder &builder, const std::vector<sf::Vector2i> &starts)const;
+
+	MultiRobotPlan MakePlan(const PathBuilder &builder)const{ return MakePlan(builder, m_Env.StartPositions()); }
+
+	//time to drive to local_vertex from the previous one while facing heading, turn included
+	float VertexCost(sf::Vector2i local_vertex, sf::Vector2i from, sf::Vector2f heading)const;
+};
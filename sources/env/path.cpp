@@ -1,10 +1,93 @@
 #include "path.hpp"
 #include <queue>
+#include <SFML/System/Clock.hpp>
 #include "bsl/assert.hpp"
 #include "bsl/log.hpp"
+#include "utils/math.hpp"
+
+PathGenerator::PathGenerator(std::vector<sf::Vector2i> initial, StepType step):
+	m_Path(std::move(initial)),
+	m_Step(std::move(step))
+{}
+
+std::vector<sf::Vector2i> PathGenerator::Resume(sf::Time budget) {
+	sf::Clock clock;
+
+	while (!m_IsFinished && !m_IsCancelled) {
+		auto next = m_Step(m_Path);
+
+		if (!next.size()) {
+			m_IsFinished = true;
+			break;
+		}
+
+		std::copy(next.begin(), next.end(), std::back_inserter(m_Path));
+
+		if(budget != sf::Time::Zero && clock.getElapsedTime() >= budget)
+			break;
+	}
+
+	std::vector<sf::Vector2i> chunk(m_Path.begin() + m_Yielded, m_Path.end());
+	m_Yielded = m_Path.size();
+	return chunk;
+}
+
+void PathGenerator::Cancel() {
+	m_IsCancelled = true;
+}
+
+bool PathGenerator::IsFinished()const {
+	return m_IsFinished;
+}
+
+bool PathGenerator::IsCancelled()const {
+	return m_IsCancelled;
+}
+
+const std::vector<sf::Vector2i>& PathGenerator::Path()const {
+	return m_Path;
+}
+
+float EstimatePathTime(const std::vector<sf::Vector2i>& path) {
+	float time = 0.f;
+
+	for (std::size_t i = 1; i < path.size(); i++) {
+		auto direction = sf::Vector2f(path[i] - path[i - 1]);
+
+		time += CleanerKinematics::MoveTime(direction.length());
+
+		if (i >= 2 && direction.length() > Eps) {
+			auto prev_direction = sf::Vector2f(path[i - 1] - path[i - 2]);
+
+			if(prev_direction.length() > Eps)
+				time += CleanerKinematics::TurnTime(Math::AngleSigned(prev_direction, direction));
+		}
+	}
+
+	return time;
+}
+
+std::unique_ptr<PathGenerator> PathBuilder::MakeGenerator(const Environment& env, const Graph& graph, sf::Vector2i from)const {
+	//whole path is built by the first Resume, not here, so it is not made when generator is cancelled right away
+	return std::make_unique<PathGenerator>(std::vector<sf::Vector2i>(), [this, &env, &graph, from](const std::vector<sf::Vector2i>& path) {
+		if(path.size())
+			return std::vector<sf::Vector2i>();
+
+		return MakePath(env, graph, from);
+	});
+}
+
+std::vector<sf::Vector2i> PathBuilder::MakePathStart(const Environment& env, sf::Vector2i from)const {
+	auto start_nearest = env.LocalNearestTo(from);
+
+	if(!start_nearest.has_value())	
+		return {};
+
+	return {from, start_nearest.value()};
+}
 
 template<typename TryGetNextPointType>
-inline std::vector<sf::Vector2i> PathBuilder::TryGetPointWithBackPropagation(const Environment &env, const std::vector<sf::Vector2i>& path, TryGetNextPointType TryGetNextPoint, bool include_back_path, bool optimize_back_path) const
+inline std::vector<sf::Vector2i> PathBuilder::TryGetPointWithBackPropagation(const Graph &graph, const std::vector<sf::Vector2i>& path, TryGetNextPointType TryGetNextPoint, bool include_back_path, bool optimize_back_path) const
 {
 	int LastIndex = path.size() - 1;
 		
@@ -24,7 +107,8 @@ inline std::vector<sf::Vector2i> PathBuilder::TryGetPointWithBackPropagation(con
 					chunk.push_back(point.value());
 				} else {
 					if(i != LastIndex) {
-						chunk = env.CoverageGraph.ShortestPath(path[BackPathStart], point.value());
+						//we arrive to BackPathStart from the last point
+						chunk = MakeTransition(graph, path[BackPathStart], point.value(), path[BackPathStart] - path[LastIndex]);
 						verify(chunk.size());
 					} else {
 						chunk.push_back(point.value());
@@ -38,6 +122,31 @@ inline std::vector<sf::Vector2i> PathBuilder::TryGetPointWithBackPropagation(con
 	return {};
 }
 
+std::vector<sf::Vector2i> PathBuilder::MakeTransition(const Graph& graph, sf::Vector2i src, sf::Vector2i dst, std::optional<sf::Vector2i> heading)const {
+	if(!TimeOptimal)
+		return graph.ShortestPath(src, dst);
+
+	return graph.FastestPath(src, dst, heading.has_value() ? std::make_optional(sf::Vector2f(heading.value())) : std::nullopt);
+}
+
+void PathBuilder::SortByTravelTime(std::vector<sf::Vector2i>& candidates, sf::Vector2i prev, sf::Vector2i point)const {
+	auto heading = sf::Vector2f(point - prev);
+
+	auto TravelTime = [&](sf::Vector2i candidate) {
+		auto direction = sf::Vector2f(candidate - point);
+		float time = CleanerKinematics::MoveTime(direction.length());
+
+		if(heading.length() > Eps && direction.length() > Eps)
+			time += CleanerKinematics::TurnTime(Math::AngleSigned(heading, direction));
+
+		return time;
+	};
+
+	std::stable_sort(candidates.begin(), candidates.end(), [&](sf::Vector2i l, sf::Vector2i r) {
+		return TravelTime(l) < TravelTime(r);
+	});
+}
+
 std::optional<sf::Vector2i> PathBuilder::FindFirstUnvisited(const Environment& env, const std::vector<sf::Vector2i>& candidates, const std::vector<sf::Vector2i>& path, const std::optional<sf::Vector2i> except, const std::optional<sf::IntRect> in_zone)const {
 	for (auto next : candidates) {
 		if (std::find(path.begin(), path.end(), next) == path.end()) {
@@ -50,9 +159,7 @@ std::optional<sf::Vector2i> PathBuilder::FindFirstUnvisited(const Environment& e
 	return std::optional<sf::Vector2i>();
 }
 
-std::vector<sf::Vector2i> BreadthSearchPathFinder::MakePath(const Environment& env, sf::Vector2i starting_point)const {
-	const auto &graph = env.CoverageGraph;
-
+std::vector<sf::Vector2i> BreadthSearchPathFinder::MakePath(const Environment& env, const Graph& graph, sf::Vector2i starting_point)const {
 	std::vector<sf::Vector2i> path;
 	auto start = starting_point;
 	auto start_nearest = env.LocalNearestTo(start);
@@ -74,9 +181,7 @@ std::vector<sf::Vector2i> BreadthSearchPathFinder::MakePath(const Environment& e
 	return path;
 }
 
-std::vector<sf::Vector2i> BreadthSearchWithSortPathFinder::MakePath(const Environment& env, sf::Vector2i starting_point)const {
-	const auto &graph = env.CoverageGraph;
-
+std::vector<sf::Vector2i> BreadthSearchWithSortPathFinder::MakePath(const Environment& env, const Graph& graph, sf::Vector2i starting_point)const {
 	std::vector<sf::Vector2i> path;
 	auto start = starting_point;
 	auto start_nearest = env.LocalNearestTo(start);
@@ -102,10 +207,8 @@ std::vector<sf::Vector2i> BreadthSearchWithSortPathFinder::MakePath(const Enviro
 	return path;
 }
 
-std::vector<sf::Vector2i> FirstNearWallPathBuilder::MakePath(const Environment& env, sf::Vector2i starting_point) const
+std::vector<sf::Vector2i> FirstNearWallPathBuilder::MakePath(const Environment& env, const Graph& graph, sf::Vector2i starting_point) const
 {
-	const auto &graph = env.CoverageGraph;
-
 	std::vector<sf::Vector2i> path;
 	auto start = starting_point;
 	auto start_nearest = env.LocalNearestTo(start);
@@ -131,126 +234,101 @@ std::vector<sf::Vector2i> FirstNearWallPathBuilder::MakePath(const Environment&
 	return path;
 }
 
-std::vector<sf::Vector2i> DirectionSortPathBuilder::MakePath(const Environment& env, sf::Vector2i starting_point) const{
+std::vector<sf::Vector2i> DirectionSortPathBuilder::MakePath(const Environment& env, const Graph& graph, sf::Vector2i starting_point) const{
+	return MakeGenerator(env, graph, starting_point)->Resume();
+}
 
-	const auto &graph = env.CoverageGraph;
+std::unique_ptr<PathGenerator> DirectionSortPathBuilder::MakeGenerator(const Environment& env, const Graph& graph, sf::Vector2i starting_point) const{
+	auto Step = [this, &env, &graph](const std::vector<sf::Vector2i> &path) {
+		auto TryGetPoint = [&](size_t last_index)->std::optional<sf::Vector2i>{
+			if(last_index == 0)
+				return std::nullopt;
 
-	std::vector<sf::Vector2i> path;
-	
-	auto start = starting_point;
-	auto start_nearest = env.LocalNearestTo(start);
-	if(!start_nearest.has_value())	
-		return {};
-	path.push_back(start);
-	path.push_back(start_nearest.value());
+			auto point = path[last_index];
+			auto direction = point - path[last_index - 1];
 
-	auto TryGetPoint = [&](size_t last_index)->std::optional<sf::Vector2i>{
-		if(last_index == 0)
-			return std::nullopt;
+			std::vector<sf::Vector2i> neighbours = graph[point].Neighbours;
 
-		auto point = path[last_index];
-		auto direction = point - path[last_index - 1];
+			if (!verify(neighbours.size()))
+				return std::nullopt;
 
-		std::vector<sf::Vector2i> neighbours = graph[point].Neighbours;
+			if(TimeOptimal)
+				SortByTravelTime(neighbours, path[last_index - 1], point);
+			else
+				std::sort(neighbours.rbegin(), neighbours.rend(), SortByDirection{ direction });
 
-		if (!verify(neighbours.size()))
-			return std::nullopt;
+			return FindFirstUnvisited(env, neighbours, path);
+		};
 
-		std::sort(neighbours.rbegin(), neighbours.rend(), SortByDirection{ direction });
-
-		return FindFirstUnvisited(env, neighbours, path);
+		return TryGetPointWithBackPropagation(graph, path, TryGetPoint, true, false);
 	};
-	
-	for (;;) {
-		auto next = TryGetPointWithBackPropagation(env, path, TryGetPoint, true, false);
-
-		//if(!next.has_value())
-		if(!next.size())
-			break;
-		
-		std::copy(next.begin(), next.end(), std::back_inserter(path));
-		//path.push_back(next.value());
-	}
-
 
-	return path;
+	return std::make_unique<PathGenerator>(MakePathStart(env, starting_point), Step);
 }
 
-std::vector<sf::Vector2i> RightFirstPathBuilder::MakePath(const Environment& env, sf::Vector2i starting_point) const{
-	const auto &graph = env.CoverageGraph;
-
-	std::vector<sf::Vector2i> path;
-
-	auto start = starting_point;
-	auto start_nearest = env.LocalNearestTo(start);
-
-	if(!start_nearest.has_value())	
-		return {};
-
-	path.push_back(start);
-	path.push_back(start_nearest.value());
-
+std::vector<sf::Vector2i> RightFirstPathBuilder::MakePath(const Environment& env, const Graph& graph, sf::Vector2i starting_point) const{
+	return MakeGenerator(env, graph, starting_point)->Resume();
+}
 
-	auto FindFirstUnvisitedByAngle = [&](sf::Vector2i point, sf::Vector2i prev, std::optional<sf::Vector2i> except = {})->std::optional<sf::Vector2i> {
-		auto direction = point - prev;
+std::unique_ptr<PathGenerator> RightFirstPathBuilder::MakeGenerator(const Environment& env, const Graph& graph, sf::Vector2i starting_point) const{
+	auto Step = [this, &env, &graph](const std::vector<sf::Vector2i> &path) {
+		auto FindFirstUnvisitedByAngle = [&](sf::Vector2i point, sf::Vector2i prev, std::optional<sf::Vector2i> except = {})->std::optional<sf::Vector2i> {
+			auto direction = point - prev;
 
-		sf::Vector2i right(sf::Vector2f(direction).rotatedBy(sf::degrees(-90)));
+			sf::Vector2i right(sf::Vector2f(direction).rotatedBy(sf::degrees(-90)));
 
-		std::vector<sf::Vector2i> neighbours = graph[point].Neighbours;
+			std::vector<sf::Vector2i> neighbours = graph[point].Neighbours;
 
-		if (!verify(neighbours.size()))
-			return std::nullopt;
+			if (!verify(neighbours.size()))
+				return std::nullopt;
 
-		std::sort(neighbours.begin(), neighbours.end(), SortByAngleCouterClockwize{ right, point });
+			if(TimeOptimal)
+				SortByTravelTime(neighbours, prev, point);
+			else
+				std::sort(neighbours.begin(), neighbours.end(), SortByAngleCouterClockwize{ right, point });
 
-		return FindFirstUnvisited(env, neighbours, path, except, Zone);
-	};
+			return FindFirstUnvisited(env, neighbours, path, except, Zone);
+		};
 
-	auto FindFirstUnvisitedByDistance = [&](sf::Vector2i point, sf::Vector2i prev, std::optional<sf::Vector2i> except = {})->std::optional<sf::Vector2i> {
-		auto direction = point - prev;
+		auto FindFirstUnvisitedByDistance = [&](sf::Vector2i point, sf::Vector2i prev, std::optional<sf::Vector2i> except = {})->std::optional<sf::Vector2i> {
+			auto direction = point - prev;
 
-		std::vector<sf::Vector2i> neighbours = graph[point].Neighbours;
+			std::vector<sf::Vector2i> neighbours = graph[point].Neighbours;
 
-		if (!verify(neighbours.size()))
-			return std::nullopt;
+			if (!verify(neighbours.size()))
+				return std::nullopt;
 
-		std::sort(neighbours.begin(), neighbours.end(), SortByDistanceTo{ point });
+			std::sort(neighbours.begin(), neighbours.end(), SortByDistanceTo{ point });
 
-		return FindFirstUnvisited(env, neighbours, path, except, Zone);
-	};
+			return FindFirstUnvisited(env, neighbours, path, except, Zone);
+		};
 
-	auto TryGetPoint = [&](std::size_t end)->std::optional<sf::Vector2i>{
-		if(end == 0)
-			return std::nullopt;
+		auto TryGetPoint = [&](std::size_t end)->std::optional<sf::Vector2i>{
+			if(end == 0)
+				return std::nullopt;
 
-		auto point = path[end];
-		auto prev = path[end - 1];
+			auto point = path[end];
+			auto prev = path[end - 1];
 
-		auto by_angle = FindFirstUnvisitedByAngle(point, prev);
+			auto by_angle = FindFirstUnvisitedByAngle(point, prev);
 #ifdef MAKE_SMALL_OPTIMIZE_BY_DISTANCE
-		auto by_distance = FindFirstUnvisitedByDistance(point, prev);
+			auto by_distance = FindFirstUnvisitedByDistance(point, prev);
 
-		if (by_distance.has_value()) {
-			auto next_by_angle = FindFirstUnvisitedByAngle(by_distance.value(), point, point);
-			auto next_by_distance = FindFirstUnvisitedByDistance(by_distance.value(), point, point);
+			if (by_distance.has_value()) {
+				auto next_by_angle = FindFirstUnvisitedByAngle(by_distance.value(), point, point);
+				auto next_by_distance = FindFirstUnvisitedByDistance(by_distance.value(), point, point);
 
-			if(next_by_angle == next_by_distance && next_by_angle == by_angle)
-				return by_distance;
-		}
+				if(next_by_angle == next_by_distance && next_by_angle == by_angle)
+					return by_distance;
+			}
 #endif
-		return by_angle;
-	};
-
-	for (;;) {
-		auto next = TryGetPointWithBackPropagation(env, path, TryGetPoint, true, true);
+			return by_angle;
+		};
 
-		if(!next.size())
-			break;
-		
-		std::copy(next.begin(), next.end(), std::back_inserter(path));
-	}
+		return TryGetPointWithBackPropagation(graph, path, TryGetPoint, true, true);
+	};
 
-	return path;
+	return std::make_unique<PathGenerator>(MakePathStart(env, starting_point), Step);
 }
 
 sf::Vector2i Right(sf::Vector2i dir) {
@@ -269,45 +347,42 @@ sf::Vector2i Dir(sf::Vector2i dir, int lr) {
 	return dir;
 }
 
-std::vector<sf::Vector2i> NonOccupiedPathBuilder::MakePath(const Environment& env, sf::Vector2i starting_point) const{
-	const auto &graph = env.CoverageGraph;
-
-	std::vector<sf::Vector2i> path;
-
-	auto start = starting_point;
-	auto start_nearest = env.LocalNearestTo(start);
+std::vector<sf::Vector2i> NonOccupiedPathBuilder::MakePath(const Environment& env, const Graph& graph, sf::Vector2i starting_point) const{
+	return MakeGenerator(env, graph, starting_point)->Resume();
+}
 
-	if(!start_nearest.has_value())	
-		return {};
+std::unique_ptr<PathGenerator> NonOccupiedPathBuilder::MakeGenerator(const Environment& env, const Graph& graph, sf::Vector2i starting_point) const{
+	//one simple zone per step
+	auto Step = [this, &env, &graph, zone_index = std::size_t(0)](const std::vector<sf::Vector2i> &path) mutable {
+		const auto &zones = env.Coverage.SimpleZoneDecompositionCache;
 
-	path.push_back(start);
-	path.push_back(start_nearest.value());
+		if(path.size() < 2)
+			return std::vector<sf::Vector2i>();
 
-	auto zones = env.Coverage.SimpleZoneDecompositionCache;
-	
-	for (auto zone : zones) {
+		while (zone_index < zones.size()) {
+			auto zone_path = MakePathForSimpleZone(env, zones[zone_index++]);
 		
-		auto zone_path = MakePathForSimpleZone(env, zone);
-		
-		std::transform(zone_path.begin(), zone_path.end(), zone_path.begin(), [&env](sf::Vector2i coverage) {
-			const auto &points = env.Coverage.LocatedVisitPointsCache[coverage];
+			std::transform(zone_path.begin(), zone_path.end(), zone_path.begin(), [&env](sf::Vector2i coverage) {
+				const auto &points = env.Coverage.LocatedVisitPoints(coverage);
 
-			if(!points.size())
-				return sf::Vector2i(0, 0);
+				if(!points.size())
+					return sf::Vector2i(0, 0);
 
-			return points.front();
-		});
+				return points.front();
+			});
 
-		auto path_to_zone = env.CoverageGraph.ShortestPath(path.back(), zone_path.front());
+			auto path_to_zone = MakeTransition(graph, path.back(), zone_path.front(), path.back() - *(path.end() - 2));
 
-		if(path_to_zone.size()){
-			std::copy(path_to_zone.begin(), path_to_zone.end(), std::back_inserter(path));
-			std::copy(zone_path.begin(), zone_path.end(), std::back_inserter(path));
+			if(path_to_zone.size()){
+				std::copy(zone_path.begin(), zone_path.end(), std::back_inserter(path_to_zone));
+				return path_to_zone;
+			}
 		}
-	}
 
+		return std::vector<sf::Vector2i>();
+	};
 
-	return path;
+	return std::make_unique<PathGenerator>(MakePathStart(env, starting_point), Step);
 }
 
 std::vector<sf::Vector2i> NonOccupiedPathBuilder::MakePathForSimpleZone(const Environment& env, sf::IntRect simple_zone) const{
@@ -335,46 +410,48 @@ std::vector<sf::Vector2i> NonOccupiedPathBuilder::MakePathForSimpleZone(const En
     return result;
 }
 
-std::vector<sf::Vector2i> RightFirstPathForZone::MakePath(const Environment& env, sf::Vector2i starting_point) const{
+std::vector<sf::Vector2i> RightFirstPathForZone::MakePath(const Environment& env, const Graph& graph, sf::Vector2i starting_point) const{
+	return MakeGenerator(env, graph, starting_point)->Resume();
+}
 
-	const auto &graph = env.CoverageGraph;
+std::unique_ptr<PathGenerator> RightFirstPathForZone::MakeGenerator(const Environment& env, const Graph& graph, sf::Vector2i starting_point) const{
+	//one zone to clean per step
+	auto Step = [this, &env, &graph, zone_index = std::size_t(0)](const std::vector<sf::Vector2i> &path) mutable {
+		const auto &zones = env.ZonesToClean;
 
-	std::vector<sf::Vector2i> path;
-	auto start = starting_point;
-	auto start_nearest = env.LocalNearestTo(start);
+		if(path.size() < 2)
+			return std::vector<sf::Vector2i>();
 
-	if(!start_nearest.has_value())	
-		return {};
+		while (zone_index < zones.size()) {
+			auto zone = zones[zone_index++];
 
-	path.push_back(start);
-	path.push_back(start_nearest.value());
+			sf::IntRect local_zone{zone.getPosition() - env.Grid.Bounds.getPosition(), zone.getSize()};
 
-	auto zones = env.ZonesToClean;
+			auto some_point_on_zone = graph.BreadthSearchByPredicate(path.back(), [local_zone](sf::Vector2i point) {
+				return local_zone.contains(point);
+			});
 	
-	for (auto zone : zones) {
+			if(!some_point_on_zone.has_value())
+				//unreachable
+				continue;
 		
-		sf::IntRect local_zone{zone.getPosition() - env.Grid.Bounds.getPosition(), zone.getSize()};
+			std::vector<sf::Vector2i> path_to_zone = MakeTransition(graph, path.back(), some_point_on_zone.value(), path.back() - *(path.end() - 2));
 
-		auto some_point_on_zone = graph.BreadthSearchByPredicate(path.back(), [local_zone](sf::Vector2i point) {
-			return local_zone.contains(point);
-		});
-	
-		if(!some_point_on_zone.has_value())
-			//unreachable
-			continue;
-		
-		std::vector<sf::Vector2i> path_to_zone = env.CoverageGraph.ShortestPath(path.back(), some_point_on_zone.value());
+			if(!verify(path_to_zone.size()))
+				//unreachable
+				continue;
 
-		if(!verify(path_to_zone.size()))
-			//unreachable
-			continue;
+			RightFirstPathBuilder zone_builder(std::make_optional(local_zone));
+			zone_builder.TimeOptimal = TimeOptimal;
 
-		std::vector<sf::Vector2i> path_on_zone = RightFirstPathBuilder(std::make_optional(local_zone)).MakePath(env, path_to_zone.back());
+			std::vector<sf::Vector2i> path_on_zone = zone_builder.MakePath(env, graph, path_to_zone.back());
 
-		std::copy(path_to_zone.begin(), path_to_zone.end(), std::back_inserter(path));
-		std::copy(path_on_zone.begin(), path_on_zone.end(), std::back_inserter(path));
-	}
+			std::copy(path_on_zone.begin(), path_on_zone.end(), std::back_inserter(path_to_zone));
+			return path_to_zone;
+		}
 
+		return std::vector<sf::Vector2i>();
+	};
 
-	return path;
+	return std::make_unique<PathGenerator>(MakePathStart(env, starting_point), Step);
 }
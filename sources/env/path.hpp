@@ -1,9 +1,53 @@
 #pragma once
 
+#include <memory>
+#include <functional>
+#include <SFML/System/Time.hpp>
 #include "environment.hpp"
 
+//Resumable path generation, env and builder should outlive the generator
+class PathGenerator {
+public:
+	//returns next chunk of the path or empty one when there is nothing left to add
+	using StepType = std::function<std::vector<sf::Vector2i>(const std::vector<sf::Vector2i> &path)>;
+private:
+	std::vector<sf::Vector2i> m_Path;
+	std::size_t m_Yielded = 0;
+	StepType m_Step;
+	bool m_IsFinished = false;
+	bool m_IsCancelled = false;
+public:
+	PathGenerator(std::vector<sf::Vector2i> initial, StepType step);
+
+	//sf::Time::Zero budget means run until finished, returns points added since last Resume
+	std::vector<sf::Vector2i> Resume(sf::Time budget = sf::Time::Zero);
+
+	void Cancel();
+
+	bool IsFinished()const;
+
+	bool IsCancelled()const;
+
+	const std::vector<sf::Vector2i> &Path()const;
+};
+
+//Rough time for cleaner to follow the path, turns in place with CleanerSpeed.y and moves with CleanerSpeed.x
+float EstimatePathTime(const std::vector<sf::Vector2i> &path);
+
 struct PathBuilder{
-	virtual std::vector<sf::Vector2i> MakePath(const Environment &env, sf::Vector2i from)const = 0;
+	//use rotation aware transitions and order candidates by travel time from current heading
+	bool TimeOptimal = false;
+
+	//walks env.CoverageGraph
+	std::vector<sf::Vector2i> MakePath(const Environment &env, sf::Vector2i from)const{ return MakePath(env, env.CoverageGraph, from); }
+
+	std::unique_ptr<PathGenerator> MakeGenerator(const Environment &env, sf::Vector2i from)const{ return MakeGenerator(env, env.CoverageGraph, from); }
+
+	//walks only the given graph, so one env can be shared by builders working on different regions
+	virtual std::vector<sf::Vector2i> MakePath(const Environment &env, const Graph &graph, sf::Vector2i from)const = 0;
+
+	//default one builds the whole path in the first Resume, env, graph and builder should outlive the generator
+	virtual std::unique_ptr<PathGenerator> MakeGenerator(const Environment &env, const Graph &graph, sf::Vector2i from)const;
 
 	virtual std::string Name()const = 0;
 
@@ -15,30 +59,48 @@ struct PathBuilder{
 		const std::optional<sf::IntRect> in_zone = {}
 	)const;
 
+	std::vector<sf::Vector2i> MakePathStart(const Environment &env, sf::Vector2i from)const;
+
+	std::vector<sf::Vector2i> MakeTransition(const Graph &graph, sf::Vector2i src, sf::Vector2i dst, std::optional<sf::Vector2i> heading = {})const;
+
+	void SortByTravelTime(std::vector<sf::Vector2i> &candidates, sf::Vector2i prev, sf::Vector2i point)const;
+
 	template<typename TryGetNextPointType>
-	std::vector<sf::Vector2i> TryGetPointWithBackPropagation(const Environment &env, const std::vector<sf::Vector2i> &path, TryGetNextPointType TryGetNextPoint, bool include_back_path = true, bool optimize_back_path = false)const;
+	std::vector<sf::Vector2i> TryGetPointWithBackPropagation(const Graph &graph, const std::vector<sf::Vector2i> &path, TryGetNextPointType TryGetNextPoint, bool include_back_path = true, bool optimize_back_path = false)const;
 };
 
 struct BreadthSearchPathFinder: PathBuilder{
-	std::vector<sf::Vector2i> MakePath(const Environment &env, sf::Vector2i starting_point)const override;
+	using PathBuilder::MakePath;
+
+	std::vector<sf::Vector2i> MakePath(const Environment &env, const Graph &graph, sf::Vector2i starting_point)const override;
 
 	std::string Name()const override{return "Breadth First"; }
 };
 
 struct BreadthSearchWithSortPathFinder: PathBuilder{
-	std::vector<sf::Vector2i> MakePath(const Environment &env, sf::Vector2i starting_point)const override;
+	using PathBuilder::MakePath;
+
+	std::vector<sf::Vector2i> MakePath(const Environment &env, const Graph &graph, sf::Vector2i starting_point)const override;
 
 	std::string Name()const override{return "Breadth First With Sort"; }
 };
 
 struct FirstNearWallPathBuilder : PathBuilder {
-	std::vector<sf::Vector2i> MakePath(const Environment &env, sf::Vector2i starting_point)const override;
+	using PathBuilder::MakePath;
+
+	std::vector<sf::Vector2i> MakePath(const Environment &env, const Graph &graph, sf::Vector2i starting_point)const override;
 
 	std::string Name()const override{return "First Near Wall - Some Cringe, don't use"; }
 };
 
 struct DirectionSortPathBuilder : PathBuilder {
-	std::vector<sf::Vector2i> MakePath(const Environment &env, sf::Vector2i starting_point)const override;
+	using PathBuilder::MakePath;
+
+	std::vector<sf::Vector2i> MakePath(const Environment &env, const Graph &graph, sf::Vector2i starting_point)const override;
+
+	using PathBuilder::MakeGenerator;
+
+	std::unique_ptr<PathGenerator> MakeGenerator(const Environment &env, const Graph &graph, sf::Vector2i starting_point)const override;
 
 	std::string Name()const override{return "Direction Sort"; }
 };
@@ -50,19 +112,37 @@ struct RightFirstPathBuilder : PathBuilder {
 		Zone(zone)
 	{}
 
-	std::vector<sf::Vector2i> MakePath(const Environment &env, sf::Vector2i starting_point)const override;
+	using PathBuilder::MakePath;
+
+	std::vector<sf::Vector2i> MakePath(const Environment &env, const Graph &graph, sf::Vector2i starting_point)const override;
+
+	using PathBuilder::MakeGenerator;
+
+	std::unique_ptr<PathGenerator> MakeGenerator(const Environment &env, const Graph &graph, sf::Vector2i starting_point)const override;
 
 	std::string Name()const override{return "Right First"; }
 };
 
 struct RightFirstPathForZone : PathBuilder {
-	std::vector<sf::Vector2i> MakePath(const Environment &env, sf::Vector2i starting_point)const override;
+	using PathBuilder::MakePath;
+
+	std::vector<sf::Vector2i> MakePath(const Environment &env, const Graph &graph, sf::Vector2i starting_point)const override;
+
+	using PathBuilder::MakeGenerator;
+
+	std::unique_ptr<PathGenerator> MakeGenerator(const Environment &env, const Graph &graph, sf::Vector2i starting_point)const override;
 
 	std::string Name()const override{return "Right First Based - For Clean Zones"; }
 };
 
 struct NonOccupiedPathBuilder : PathBuilder {
-	std::vector<sf::Vector2i> MakePath(const Environment &env, sf::Vector2i starting_point)const override;
+	using PathBuilder::MakePath;
+
+	std::vector<sf::Vector2i> MakePath(const Environment &env, const Graph &graph, sf::Vector2i starting_point)const override;
+
+	using PathBuilder::MakeGenerator;
+
+	std::unique_ptr<PathGenerator> MakeGenerator(const Environment &env, const Graph &graph, sf::Vector2i starting_point)const override;
 
 	std::vector<sf::Vector2i> MakePathForSimpleZone(const Environment &env, sf::IntRect simple_zone)const;
 
@@ -0,0 +1,255 @@
+#include "path_coverage.hpp"
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+PathCoverageEvaluator::PathCoverageEvaluator(const Environment& env):
+	m_Bounds(env.Grid.Bounds),
+	m_CellSize(std::max<int>(env.Grid.CellSize, 1)),
+	m_Size(env.Grid.Size())
+{
+	std::size_t count = m_Size.x * m_Size.y;
+
+	std::vector<std::uint8_t> occupied(count, 0);
+	for (auto cell : env.Grid.OccupiedIndices) {
+		if(env.Grid.IsInBounds(cell))
+			occupied[Index(cell)] = 1;
+	}
+
+	m_Floor.resize(count, 0);
+	m_LastSegment.resize(count, 0);
+	m_Overlapped.resize(count, 0);
+
+	auto start = env.StartPosition - m_Bounds.getPosition();
+	sf::Vector2i start_cell = start.x >= 0 && start.y >= 0 ? start / m_CellSize : sf::Vector2i(-1, -1);
+
+	if (!env.Grid.IsInBounds(start_cell) || occupied[Index(start_cell)]) {
+		//can't tell inside from outside, treat everything free as floor
+		for (std::size_t i = 0; i < count; i++) {
+			m_Floor[i] = !occupied[i];
+		}
+	} else {
+		std::vector<sf::Vector2i> frontier{start_cell};
+		m_Floor[Index(start_cell)] = 1;
+
+		const sf::Vector2i Directions[] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}};
+
+		while (frontier.size()) {
+			auto cell = frontier.back();
+			frontier.pop_back();
+
+			for (auto dir : Directions) {
+				auto next = cell + dir;
+
+				if(!env.Grid.IsInBounds(next) || occupied[Index(next)] || m_Floor[Index(next)])
+					continue;
+
+				m_Floor[Index(next)] = 1;
+				frontier.push_back(next);
+			}
+		}
+	}
+
+	m_FloorCount = std::count(m_Floor.begin(), m_Floor.end(), 1);
+}
+
+PathCoverageReport PathCoverageEvaluator::Evaluate(const std::vector<sf::Vector2i>& path, const std::vector<sf::IntRect>& zones, float radius) const{
+	PathCoverageReport report;
+	report.FloorCells = m_FloorCount;
+
+	std::fill(m_LastSegment.begin(), m_LastSegment.end(), 0);
+	std::fill(m_Overlapped.begin(), m_Overlapped.end(), 0);
+
+	if(!path.size() || !m_FloorCount)
+		return report;
+
+	const float cell_radius = radius / m_CellSize;
+
+	//segments are numbered from 1, 0 means not covered
+	auto Sweep = [&](sf::Vector2i from, sf::Vector2i to, std::uint32_t segment) {
+		RasterizeCapsule(WorldToCellSpace(from), WorldToCellSpace(to), cell_radius, [&](std::size_t index) {
+			auto &last = m_LastSegment[index];
+
+			//neighbour segments always share the joint disk, that is not an overlap
+			if(last && last + 1 < segment)
+				m_Overlapped[index] = 1;
+
+			last = segment;
+		});
+	};
+
+	if(path.size() == 1)
+		Sweep(path[0], path[0], 1);
+
+	for (std::size_t i = 0; i + 1 < path.size(); i++) {
+		Sweep(path[i], path[i + 1], i + 1);
+	}
+
+	std::size_t overlapped = 0;
+	for (std::size_t i = 0; i < m_Floor.size(); i++) {
+		if(!m_Floor[i] || !m_LastSegment[i])
+			continue;
+
+		report.CoveredCells++;
+		overlapped += m_Overlapped[i];
+	}
+
+	report.Covered = report.CoveredCells / float(m_FloorCount);
+	report.Overlap = overlapped / float(m_FloorCount);
+	report.MissedRegions = GatherMissedRegions();
+
+	for (auto zone : zones) {
+		std::size_t floor = 0;
+		std::size_t covered = 0;
+
+		for (int y = 0; y < m_Size.y; y++) {
+			for (int x = 0; x < m_Size.x; x++) {
+				sf::Vector2i cell(x, y);
+				sf::Vector2i center = m_Bounds.getPosition() + cell * m_CellSize + sf::Vector2i(m_CellSize, m_CellSize) / 2;
+
+				if(!zone.contains(center) || !m_Floor[Index(cell)])
+					continue;
+
+				floor++;
+				covered += m_LastSegment[Index(cell)] != 0;
+			}
+		}
+
+		report.ZonesCoverage.push_back(floor ? covered / float(floor) : 1.f);
+	}
+
+	return report;
+}
+
+bool PathCoverageEvaluator::IsFloor(sf::Vector2i cell)const {
+	if(cell.x < 0 || cell.y < 0 || cell.x >= m_Size.x || cell.y >= m_Size.y)
+		return false;
+
+	return m_Floor[Index(cell)];
+}
+
+sf::Vector2f PathCoverageEvaluator::WorldToCellSpace(sf::Vector2i point)const {
+	//cell centers land on integer coordinates
+	return sf::Vector2f(point - m_Bounds.getPosition()) / float(m_CellSize) - sf::Vector2f(0.5f, 0.5f);
+}
+
+template<typename VisitorType>
+void PathCoverageEvaluator::RasterizeCapsule(sf::Vector2f a, sf::Vector2f b, float radius, VisitorType visitor) const{
+	constexpr float Inf = std::numeric_limits<float>::infinity();
+
+	int first_row = std::max(0, (int)std::floor(std::min(a.y, b.y) - radius));
+	int last_row = std::min(m_Size.y - 1, (int)std::ceil(std::max(a.y, b.y) + radius));
+
+	sf::Vector2f direction = b - a;
+	float length = direction.length();
+
+	sf::Vector2f along = length > Eps ? direction / length : sf::Vector2f();
+	sf::Vector2f across(-along.y, along.x);
+
+	//x range where (coefficient * x + offset) is in [min, max]
+	auto Solve = [](float coefficient, float offset, float min, float max, float &lo, float &hi) {
+		if (std::abs(coefficient) < Eps) {
+			if (offset < min || offset > max) {
+				lo = Inf;
+				hi = -Inf;
+			}
+			return;
+		}
+		float first = (min - offset) / coefficient;
+		float second = (max - offset) / coefficient;
+
+		lo = std::max(lo, std::min(first, second));
+		hi = std::min(hi, std::max(first, second));
+	};
+
+	for (int row = first_row; row <= last_row; row++) {
+		float y = row;
+		float lo = Inf;
+		float hi = -Inf;
+
+		for (auto center : {a, b}) {
+			float dy = y - center.y;
+			if(std::abs(dy) > radius)
+				continue;
+
+			float half = std::sqrt(radius * radius - dy * dy);
+			lo = std::min(lo, center.x - half);
+			hi = std::max(hi, center.x + half);
+		}
+
+		if (length > Eps) {
+			float slab_lo = -Inf;
+			float slab_hi = Inf;
+			float dy = y - a.y;
+
+			Solve(along.x, along.y * dy - along.x * a.x, 0, length, slab_lo, slab_hi);
+			Solve(across.x, across.y * dy - across.x * a.x, -radius, radius, slab_lo, slab_hi);
+
+			if (slab_lo <= slab_hi) {
+				lo = std::min(lo, slab_lo);
+				hi = std::max(hi, slab_hi);
+			}
+		}
+
+		//row misses the capsule, infinities can't be converted to int
+		if(lo > hi || !std::isfinite(lo) || !std::isfinite(hi))
+			continue;
+
+		//clamped before conversion so far away capsules don't overflow int
+		int first_column = (int)std::ceil(std::clamp(lo, 0.f, float(m_Size.x)));
+		int last_column = (int)std::floor(std::clamp(hi, -1.f, float(m_Size.x - 1)));
+
+		std::size_t row_start = std::size_t(row) * m_Size.x;
+		for (int column = first_column; column <= last_column; column++) {
+			visitor(row_start + column);
+		}
+	}
+}
+
+std::vector<sf::IntRect> PathCoverageEvaluator::GatherMissedRegions()const {
+	std::vector<sf::IntRect> regions;
+	std::vector<std::uint8_t> visited(m_Floor.size(), 0);
+	std::vector<sf::Vector2i> frontier;
+
+	const sf::Vector2i Directions[] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}};
+
+	auto IsMissed = [&](sf::Vector2i cell) {
+		return IsFloor(cell) && !m_LastSegment[Index(cell)] && !visited[Index(cell)];
+	};
+
+	for (int y = 0; y < m_Size.y; y++) {
+		for (int x = 0; x < m_Size.x; x++) {
+			if(!IsMissed({x, y}))
+				continue;
+
+			sf::Vector2i min(x, y);
+			sf::Vector2i max(x, y);
+
+			frontier.push_back({x, y});
+			visited[Index({x, y})] = 1;
+
+			while (frontier.size()) {
+				auto cell = frontier.back();
+				frontier.pop_back();
+
+				min = {std::min(min.x, cell.x), std::min(min.y, cell.y)};
+				max = {std::max(max.x, cell.x), std::max(max.y, cell.y)};
+
+				for (auto dir : Directions) {
+					auto next = cell + dir;
+
+					if(!IsMissed(next))
+						continue;
+
+					visited[Index(next)] = 1;
+					frontier.push_back(next);
+				}
+			}
+
+			sf::Vector2i size = max - min + sf::Vector2i(1, 1);
+			regions.push_back({m_Bounds.getPosition() + min * m_CellSize, size * m_CellSize});
+		}
+	}
+
+	return regions;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <SFML/System/Vector2.hpp>
+#include <SFML/Graphics/Rect.hpp>
+#include "env/environment.hpp"
+
+struct PathCoverageReport {
+	//all of them are in [0, 1] range, relative to reachable floor cells
+	float Covered = 0.f;
+	//covered cells that were swept again later by non adjacent path segment
+	float Overlap = 0.f;
+
+	std::size_t FloorCells = 0;
+	std::size_t CoveredCells = 0;
+
+	//bounds of connected uncovered floor areas, in world space
+	std::vector<sf::IntRect> MissedRegions;
+	//same order as ZonesToClean
+	std::vector<float> ZonesCoverage;
+};
+
+//Rasterizes disk of CleanerRadius swept along the path into the grid decomposition resolution bitmap
+class PathCoverageEvaluator {
+	sf::IntRect m_Bounds;
+	int m_CellSize = 1;
+	sf::Vector2i m_Size;
+
+	std::vector<std::uint8_t> m_Floor;
+	std::size_t m_FloorCount = 0;
+
+	//reused between evaluations to not allocate inside optimization loops
+	mutable std::vector<std::uint32_t> m_LastSegment;
+	mutable std::vector<std::uint8_t> m_Overlapped;
+public:
+	//Environment should be baked
+	PathCoverageEvaluator(const Environment &env);
+
+	PathCoverageReport Evaluate(const std::vector<sf::Vector2i> &path, const std::vector<sf::IntRect> &zones = {}, float radius = CleanerRadius)const;
+
+	bool IsFloor(sf::Vector2i cell)const;
+
+	std::size_t FloorCount()const{ return m_FloorCount; }
+
+private:
+	std::size_t Index(sf::Vector2i cell)const{ return cell.y * m_Size.x + cell.x; }
+
+	sf::Vector2f WorldToCellSpace(sf::Vector2i point)const;
+
+	template<typename VisitorType>
+	void RasterizeCapsule(sf::Vector2f a, sf::Vector2f b, float radius, VisitorType visitor)const;
+
+	std::vector<sf::IntRect> GatherMissedRegions()const;
+};
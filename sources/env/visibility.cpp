@@ -0,0 +1,182 @@
+#include "visibility.hpp"
+#include <cmath>
+#include <algorithm>
+#include <limits>
+#include "utils/math.hpp"
+
+static constexpr float Pi2 = 6.28318530718f;
+static constexpr float NoHitDistance = 9999999999.f;
+
+bool VisibilityPolygon::NearerAlongRay::operator()(std::int32_t left, std::int32_t right)const {
+	double left_distance = Polygon->DistanceAlongSweep(left);
+	double right_distance = Polygon->DistanceAlongSweep(right);
+
+	if(left_distance != right_distance)
+		return left_distance < right_distance;
+
+	//walls sharing a corner, brute force prefers the first one
+	return left < right;
+}
+
+VisibilityPolygon::VisibilityPolygon(sf::Vector2f origin, const std::vector<Wall>& walls) {
+	Build(origin, walls);
+}
+
+void VisibilityPolygon::Build(sf::Vector2f origin, const std::vector<Wall>& walls) {
+	using ActiveSet = std::set<std::int32_t, NearerAlongRay>;
+
+	m_Origin = origin;
+	m_Walls = &walls;
+	m_Intervals.clear();
+	m_Events.clear();
+
+	ActiveSet active(NearerAlongRay{this});
+	m_Active.assign(walls.size(), active.end());
+
+	std::vector<std::int32_t> wrapped;
+
+	for (std::size_t i = 0; i < walls.size(); i++) {
+		sf::Vector2f start = sf::Vector2f(walls[i].Start) - origin;
+		sf::Vector2f end = sf::Vector2f(walls[i].End) - origin;
+
+		//seen edge on, covers no angle
+		float cross = start.cross(end);
+		if(cross == 0.f)
+			continue;
+
+		float start_angle = NormalizeAngle(std::atan2(start.y, start.x));
+		float end_angle = NormalizeAngle(std::atan2(end.y, end.x));
+
+		//sweep goes with increasing angle
+		float begin = cross > 0.f ? start_angle : end_angle;
+		float finish = cross > 0.f ? end_angle : start_angle;
+
+		m_Events.push_back({begin, std::int32_t(i), true});
+		m_Events.push_back({finish, std::int32_t(i), false});
+
+		if(begin > finish)
+			wrapped.push_back(i);
+	}
+
+	if(m_Events.empty())
+		return;
+
+	std::sort(m_Events.begin(), m_Events.end(), [](const Event &left, const Event &right) {
+		if(left.Angle != right.Angle)
+			return left.Angle < right.Angle;
+		//walls ending at the corner leave before the ones starting there
+		return left.Insert < right.Insert;
+	});
+
+	auto PushInterval = [&](float begin) {
+		std::int32_t wall = active.empty() ? -1 : *active.begin();
+
+		if(m_Intervals.size() && m_Intervals.back().Wall == wall)
+			return;
+
+		m_Intervals.push_back({begin, wall});
+	};
+
+	auto SweepAt = [&](float angle) {
+		m_SweepDirection = {std::cos(angle), std::sin(angle)};
+	};
+
+	SweepAt(m_Events.front().Angle * 0.5f);
+	for (auto wall : wrapped) {
+		m_Active[wall] = active.insert(wall).first;
+	}
+	if(m_Events.front().Angle > 0.f)
+		PushInterval(0.f);
+
+	for (std::size_t first = 0; first < m_Events.size();) {
+		float angle = m_Events[first].Angle;
+
+		std::size_t last = first;
+		while (last < m_Events.size() && m_Events[last].Angle == angle) {
+			last++;
+		}
+
+		float next = last < m_Events.size() ? m_Events[last].Angle : Pi2;
+
+		for (std::size_t i = first; i < last; i++) {
+			const auto &event = m_Events[i];
+
+			if(event.Insert || m_Active[event.Wall] == active.end())
+				continue;
+
+			active.erase(m_Active[event.Wall]);
+			m_Active[event.Wall] = active.end();
+		}
+
+		//order of walls is defined inside the interval, not on its borders where they can touch
+		SweepAt((angle + next) * 0.5f);
+
+		for (std::size_t i = first; i < last; i++) {
+			const auto &event = m_Events[i];
+
+			if(event.Insert)
+				m_Active[event.Wall] = active.insert(event.Wall).first;
+		}
+
+		PushInterval(angle);
+
+		first = last;
+	}
+}
+
+std::int32_t VisibilityPolygon::VisibleWall(float angle)const {
+	if(m_Intervals.empty())
+		return -1;
+
+	angle = NormalizeAngle(angle);
+
+	auto it = std::upper_bound(m_Intervals.begin(), m_Intervals.end(), angle, [](float angle, const Interval &interval) {
+		return angle < interval.Begin;
+	});
+
+	if(it == m_Intervals.begin())
+		return -1;
+
+	return std::prev(it)->Wall;
+}
+
+std::pair<float, sf::Vector2f> VisibilityPolygon::Trace(sf::Vector2f direction)const {
+	if(!m_Walls)
+		return std::make_pair(NoHitDistance, sf::Vector2f{});
+
+	std::int32_t wall = VisibleWall(std::atan2(direction.y, direction.x));
+
+	if (wall >= 0) {
+		const auto &visible = (*m_Walls)[wall];
+		auto hit = Math::RayLineIntersectionWithNormal(m_Origin, direction, sf::Vector2f(visible.Start), sf::Vector2f(visible.End));
+
+		if(hit.has_value())
+			return hit.value();
+	}
+
+	//beam goes exactly through a corner, or nothing is visible, let exact trace decide
+	return Wall::TraceNearestObstacleWithNormal(m_Origin, direction, *m_Walls);
+}
+
+float VisibilityPolygon::NormalizeAngle(float radians) {
+	radians = std::fmod(radians, Pi2);
+
+	if(radians < 0.f)
+		radians += Pi2;
+
+	//fmod of values close to -0 can round up to Pi2
+	return radians >= Pi2 ? 0.f : radians;
+}
+
+float VisibilityPolygon::DistanceAlongSweep(std::int32_t wall)const {
+	sf::Vector2f start = sf::Vector2f((*m_Walls)[wall].Start) - m_Origin;
+	sf::Vector2f end = sf::Vector2f((*m_Walls)[wall].End) - m_Origin;
+	sf::Vector2f segment = end - start;
+
+	double denominator = double(m_SweepDirection.x) * segment.y - double(m_SweepDirection.y) * segment.x;
+
+	if(denominator == 0.0)
+		return std::numeric_limits<float>::max();
+
+	return (double(start.x) * segment.y - double(start.y) * segment.x) / denominator;
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <vector>
+#include <set>
+#include <cstdint>
+#include <SFML/System/Vector2.hpp>
+#include "env/wall.hpp"
+
+//Nearest visible wall for every direction around the origin, built by angular sweep over wall endpoints in O(W log W).
+//Polygon is kept as angular intervals, each one sees a single wall or nothing
+class VisibilityPolygon {
+public:
+	struct Interval {
+		//radians in [0, 2pi), interval ends where the next one begins
+		float Begin = 0.f;
+		std::int32_t Wall = -1;
+	};
+private:
+	struct Event {
+		float Angle = 0.f;
+		std::int32_t Wall = -1;
+		bool Insert = false;
+	};
+
+	//orders active walls by distance along the ray at current sweep angle
+	struct NearerAlongRay {
+		const VisibilityPolygon *Polygon = nullptr;
+
+		bool operator()(std::int32_t left, std::int32_t right)const;
+	};
+
+	sf::Vector2f m_Origin;
+	const std::vector<Wall> *m_Walls = nullptr;
+	sf::Vector2f m_SweepDirection;
+
+	std::vector<Interval> m_Intervals;
+
+	//kept between builds to not allocate every tick
+	std::vector<Event> m_Events;
+	std::vector<std::set<std::int32_t, NearerAlongRay>::iterator> m_Active;
+public:
+	VisibilityPolygon() = default;
+
+	VisibilityPolygon(sf::Vector2f origin, const std::vector<Wall> &walls);
+
+	//walls should outlive the polygon, they are referenced to resolve exact hits
+	void Build(sf::Vector2f origin, const std::vector<Wall> &walls);
+
+	//-1 if nothing is visible in that direction
+	std::int32_t VisibleWall(float angle)const;
+
+	//same output as Wall::TraceNearestObstacleWithNormal, direction should start at polygon origin
+	std::pair<float, sf::Vector2f> Trace(sf::Vector2f direction)const;
+
+	const std::vector<Interval> &Intervals()const{ return m_Intervals; }
+
+	sf::Vector2f Origin()const{ return m_Origin; }
+
+	static float NormalizeAngle(float radians);
+
+private:
+	float DistanceAlongSweep(std::int32_t wall)const;
+};
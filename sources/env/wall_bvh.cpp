@@ -0,0 +1,221 @@
+#include "wall_bvh.hpp"
+#include <algorithm>
+#include <limits>
+#include "utils/math.hpp"
+
+//boxes are inflated so rounding in the exact intersection test can't place a hit outside of them
+static constexpr float BoxPadding = 1.f;
+
+static constexpr float NoHitDistance = 9999999999.f;
+
+WallBVH::WallBVH(const std::vector<Wall>& walls):
+	m_Walls(walls)
+{
+	if(!m_Walls.size())
+		return;
+
+	m_Indices.resize(m_Walls.size());
+	for (std::uint32_t i = 0; i < m_Indices.size(); i++)
+		m_Indices[i] = i;
+
+	m_Nodes.reserve(m_Walls.size() * 2);
+	m_Nodes.emplace_back();
+	Build(0, 0, m_Indices.size());
+}
+
+void WallBVH::Build(std::uint32_t node, std::uint32_t first, std::uint32_t count) {
+	sf::Vector2f min( std::numeric_limits<float>::max(),  std::numeric_limits<float>::max());
+	sf::Vector2f max(-std::numeric_limits<float>::max(), -std::numeric_limits<float>::max());
+
+	for (std::uint32_t i = first; i < first + count; i++) {
+		const auto &wall = m_Walls[m_Indices[i]];
+
+		for (auto point : {sf::Vector2f(wall.Start), sf::Vector2f(wall.End)}) {
+			min = {std::min(min.x, point.x), std::min(min.y, point.y)};
+			max = {std::max(max.x, point.x), std::max(max.y, point.y)};
+		}
+	}
+
+	m_Nodes[node].Min = min - sf::Vector2f(BoxPadding, BoxPadding);
+	m_Nodes[node].Max = max + sf::Vector2f(BoxPadding, BoxPadding);
+
+	if (count <= MaxLeafSize) {
+		m_Nodes[node].First = first;
+		m_Nodes[node].Count = count;
+		return;
+	}
+
+	//median split by wall centers along the longest axis
+	int axis = (max.x - min.x) >= (max.y - min.y) ? 0 : 1;
+
+	auto Center = [&](std::uint32_t wall) {
+		auto center = sf::Vector2f(m_Walls[wall].Start + m_Walls[wall].End) / 2.f;
+		return axis == 0 ? center.x : center.y;
+	};
+
+	auto begin = m_Indices.begin() + first;
+	std::nth_element(begin, begin + count / 2, begin + count, [&](std::uint32_t l, std::uint32_t r) {
+		return Center(l) < Center(r);
+	});
+
+	std::uint32_t left = m_Nodes.size();
+	m_Nodes[node].First = left;
+	m_Nodes[node].Count = 0;
+
+	m_Nodes.emplace_back();
+	m_Nodes.emplace_back();
+
+	Build(left, first, count / 2);
+	Build(left + 1, first + count / 2, count - count / 2);
+}
+
+bool WallBVH::IntersectsBox(sf::Vector2f position, sf::Vector2f direction, sf::Vector2f min, sf::Vector2f max, float max_distance, float &entry) {
+	float near = 0.f;
+	float far = max_distance;
+
+	for (int axis = 0; axis < 2; axis++) {
+		float origin = axis == 0 ? position.x : position.y;
+		float dir = axis == 0 ? direction.x : direction.y;
+		float lo = axis == 0 ? min.x : min.y;
+		float hi = axis == 0 ? max.x : max.y;
+
+		if (std::abs(dir) < 1e-12f) {
+			if(origin < lo || origin > hi)
+				return false;
+			continue;
+		}
+
+		float t1 = (lo - origin) / dir;
+		float t2 = (hi - origin) / dir;
+
+		near = std::max(near, std::min(t1, t2));
+		far = std::min(far, std::max(t1, t2));
+
+		if(near > far)
+			return false;
+	}
+
+	entry = near;
+	return true;
+}
+
+template<typename IntersectionType>
+std::optional<WallBVH::Hit> WallBVH::Trace(sf::Vector2f position, sf::Vector2f direction, IntersectionType intersection, std::optional<Hit> nearest)const {
+	if(IsEmpty())
+		return nearest;
+
+	//never pruned by distance, the padded boxes and exact wall tests decide
+	auto Limit = [&]() {
+		return nearest.has_value() ? nearest->Distance + BoxPadding : std::numeric_limits<float>::max();
+	};
+
+	std::uint32_t stack[64];
+	std::size_t stack_size = 0;
+	stack[stack_size++] = 0;
+
+	while (stack_size) {
+		const Node &node = m_Nodes[stack[--stack_size]];
+
+		if (node.IsLeaf()) {
+			for (std::uint32_t i = node.First; i < node.First + node.Count; i++) {
+				std::uint32_t index = m_Indices[i];
+				const auto &wall = m_Walls[index];
+
+				auto result = intersection(position, direction, sf::Vector2f(wall.Start), sf::Vector2f(wall.End));
+
+				if(!result.has_value())
+					continue;
+
+				//on ties brute force keeps the first wall in the list
+				if (!nearest.has_value() || result->first < nearest->Distance || (result->first == nearest->Distance && index < nearest->Wall))
+					nearest = Hit{result->first, result->second, index};
+			}
+			continue;
+		}
+
+		float left_entry = 0.f;
+		float right_entry = 0.f;
+		bool left = IntersectsBox(position, direction, m_Nodes[node.First].Min, m_Nodes[node.First].Max, Limit(), left_entry);
+		bool right = IntersectsBox(position, direction, m_Nodes[node.First + 1].Min, m_Nodes[node.First + 1].Max, Limit(), right_entry);
+
+		//nearest child goes last so it is popped first
+		if (left && right) {
+			bool left_first = left_entry <= right_entry;
+			stack[stack_size++] = left_first ? node.First + 1 : node.First;
+			stack[stack_size++] = left_first ? node.First : node.First + 1;
+		} else if (left) {
+			stack[stack_size++] = node.First;
+		} else if (right) {
+			stack[stack_size++] = node.First + 1;
+		}
+	}
+
+	return nearest;
+}
+
+float WallBVH::TraceNearestObstacle(sf::Vector2f position, sf::Vector2f direction)const {
+	auto nearest = Trace(position, direction, [](sf::Vector2f origin, sf::Vector2f dir, sf::Vector2f start, sf::Vector2f end) -> std::optional<std::pair<float, sf::Vector2f>> {
+		auto result = Math::RayLineIntersection(origin, dir, start, end);
+
+		if(!result.has_value())
+			return std::nullopt;
+
+		return std::make_pair(result.value(), sf::Vector2f());
+	});
+
+	return nearest.has_value() ? nearest->Distance : NoHitDistance;
+}
+
+std::pair<float, sf::Vector2f> WallBVH::TraceNearestObstacleWithNormal(sf::Vector2f position, sf::Vector2f direction)const {
+	auto nearest = Trace(position, direction, Math::RayLineIntersectionWithNormal);
+
+	return nearest.has_value() ? std::make_pair(nearest->Distance, nearest->Normal) : std::make_pair(NoHitDistance, sf::Vector2f{});
+}
+
+std::pair<float, sf::Vector2f> WallBVH::TraceNearestObstacleWithNormal(sf::Vector2f position, sf::Vector2f direction, std::int32_t &hint_wall)const {
+	std::optional<Hit> seed;
+
+	if (hint_wall >= 0 && hint_wall < m_Walls.size()) {
+		const auto &wall = m_Walls[hint_wall];
+		auto result = Math::RayLineIntersectionWithNormal(position, direction, sf::Vector2f(wall.Start), sf::Vector2f(wall.End));
+
+		//the hinted wall is visited once more during traversal, that is fine since the tie rule keeps it
+		if(result.has_value())
+			seed = Hit{result->first, result->second, std::size_t(hint_wall)};
+	}
+
+	auto nearest = Trace(position, direction, Math::RayLineIntersectionWithNormal, seed);
+
+	hint_wall = nearest.has_value() ? std::int32_t(nearest->Wall) : -1;
+
+	return nearest.has_value() ? std::make_pair(nearest->Distance, nearest->Normal) : std::make_pair(NoHitDistance, sf::Vector2f{});
+}
+
+bool WallBVH::IsBuiltFor(const std::vector<Wall>& walls)const {
+	if(walls.size() != m_Walls.size())
+		return false;
+
+	for (std::size_t i = 0; i < walls.size(); i++) {
+		if(walls[i].Start != m_Walls[i].Start || walls[i].End != m_Walls[i].End)
+			return false;
+	}
+
+	return true;
+}
+
+std::size_t WallBVH::Validate(const std::vector<std::pair<sf::Vector2f, sf::Vector2f>>& rays)const {
+	std::size_t mismatches = 0;
+
+	for (auto [position, direction] : rays) {
+		auto expected = Wall::TraceNearestObstacleWithNormal(position, direction, m_Walls);
+		auto actual = TraceNearestObstacleWithNormal(position, direction);
+
+		if(expected.first != actual.first || expected.second != actual.second)
+			mismatches++;
+
+		if(Wall::TraceNearestObstacle(position, direction, m_Walls) != TraceNearestObstacle(position, direction))
+			mismatches++;
+	}
+
+	return mismatches;
+}
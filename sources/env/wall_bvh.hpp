@@ -0,0 +1,61 @@
+#pragma once
+
+#include <vector>
+#include <optional>
+#include <SFML/System/Vector2.hpp>
+#include "env/wall.hpp"
+
+//Bounding volume hierarchy over walls for nearest ray hit queries.
+//Gives exactly the same results as Wall::TraceNearestObstacle* brute force versions
+class WallBVH {
+	struct Node {
+		sf::Vector2f Min;
+		sf::Vector2f Max;
+		//for leaves First is index into m_Indices, otherwise index of the left child, right one goes next
+		std::uint32_t First = 0;
+		std::uint32_t Count = 0;
+
+		bool IsLeaf()const{ return Count != 0; }
+	};
+
+	struct Hit {
+		float Distance = 0.f;
+		sf::Vector2f Normal;
+		std::size_t Wall = 0;
+	};
+
+	std::vector<Node> m_Nodes;
+	std::vector<std::uint32_t> m_Indices;
+	std::vector<Wall> m_Walls;
+public:
+	static constexpr std::size_t MaxLeafSize = 4;
+
+	WallBVH() = default;
+
+	WallBVH(const std::vector<Wall> &walls);
+
+	float TraceNearestObstacle(sf::Vector2f position, sf::Vector2f direction)const;
+
+	std::pair<float, sf::Vector2f> TraceNearestObstacleWithNormal(sf::Vector2f position, sf::Vector2f direction)const;
+
+	//hint_wall is tested first so its hit distance bounds the traversal, on return holds the wall actually hit or -1
+	std::pair<float, sf::Vector2f> TraceNearestObstacleWithNormal(sf::Vector2f position, sf::Vector2f direction, std::int32_t &hint_wall)const;
+
+	//BVH is built for a copy of walls, it should be rebuilt once they change
+	bool IsBuiltFor(const std::vector<Wall> &walls)const;
+
+	bool IsEmpty()const{ return m_Nodes.empty(); }
+
+	std::size_t WallsCount()const{ return m_Walls.size(); }
+
+	//compares against brute force for every sample ray, returns number of mismatches
+	std::size_t Validate(const std::vector<std::pair<sf::Vector2f, sf::Vector2f>> &rays)const;
+
+private:
+	void Build(std::uint32_t node, std::uint32_t first, std::uint32_t count);
+
+	template<typename IntersectionType>
+	std::optional<Hit> Trace(sf::Vector2f position, sf::Vector2f direction, IntersectionType intersection, std::optional<Hit> nearest = std::nullopt)const;
+
+	static bool IntersectsBox(sf::Vector2f position, sf::Vector2f direction, sf::Vector2f min, sf::Vector2f max, float max_distance, float &entry);
+};
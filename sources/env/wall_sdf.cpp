@@ -0,0 +1,198 @@
+#include "wall_sdf.hpp"
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <cassert>
+#include "utils/random.hpp"
+
+static float SegmentDistanceSquared(sf::Vector2f point, sf::Vector2f start, sf::Vector2f end) {
+	sf::Vector2f segment = end - start;
+	float length_squared = segment.dot(segment);
+
+	float t = length_squared > 0.f ? std::clamp((point - start).dot(segment) / length_squared, 0.f, 1.f) : 0.f;
+	sf::Vector2f offset = point - (start + segment * t);
+
+	return offset.dot(offset);
+}
+
+WallSDF::WallSDF(const std::vector<Wall>& walls, sf::FloatRect bounds, float resolution):
+	m_Bounds(bounds),
+	m_Resolution(std::max(resolution, 0.01f)),
+	m_WallsCount(walls.size())
+{
+	m_Size.x = std::max(2, int(std::ceil(bounds.width / m_Resolution)) + 1);
+	m_Size.y = std::max(2, int(std::ceil(bounds.height / m_Resolution)) + 1);
+
+	m_Samples.resize(m_Size.x * m_Size.y);
+
+	for (int y = 0; y < m_Size.y; y++) {
+		for (int x = 0; x < m_Size.x; x++) {
+			sf::Vector2f point = m_Bounds.getPosition() + sf::Vector2f(x, y) * m_Resolution;
+
+			m_Samples[y * m_Size.x + x] = ExactDistance(point, walls);
+		}
+	}
+}
+
+float WallSDF::Distance(sf::Vector2f point)const {
+	if(IsEmpty())
+		return NoHitDistance;
+
+	sf::Vector2f local = (point - m_Bounds.getPosition()) / m_Resolution;
+	sf::Vector2f clamped(
+		std::clamp(local.x, 0.f, float(m_Size.x - 1)),
+		std::clamp(local.y, 0.f, float(m_Size.y - 1))
+	);
+	//outside of the bounds distance can only grow, this keeps it conservative for crash checks
+	float outside = (local - clamped).length() * m_Resolution;
+
+	int x = std::min(int(clamped.x), m_Size.x - 2);
+	int y = std::min(int(clamped.y), m_Size.y - 2);
+	float u = clamped.x - x;
+	float v = clamped.y - y;
+
+	float top = Sample(x, y) * (1.f - u) + Sample(x + 1, y) * u;
+	float bottom = Sample(x, y + 1) * (1.f - u) + Sample(x + 1, y + 1) * u;
+
+	return top * (1.f - v) + bottom * v + outside;
+}
+
+sf::Vector2f WallSDF::Gradient(sf::Vector2f point)const {
+	float h = m_Resolution * 0.5f;
+
+	sf::Vector2f gradient(
+		Distance(point + sf::Vector2f(h, 0)) - Distance(point - sf::Vector2f(h, 0)),
+		Distance(point + sf::Vector2f(0, h)) - Distance(point - sf::Vector2f(0, h))
+	);
+
+	if(gradient.x == 0.f && gradient.y == 0.f)
+		return {};
+
+	return gradient.normalized();
+}
+
+float WallSDF::SphereTrace(sf::Vector2f position, sf::Vector2f direction)const {
+	float length = direction.length();
+	if(IsEmpty() || length == 0.f)
+		return NoHitDistance;
+
+	sf::Vector2f dir = direction / length;
+
+	//bounds contain all the walls, once ray has left them there is nothing to hit
+	float near = 0.f;
+	float far = std::numeric_limits<float>::infinity();
+
+	for (int axis = 0; axis < 2; axis++) {
+		float origin = axis == 0 ? position.x : position.y;
+		float d = axis == 0 ? dir.x : dir.y;
+		float lo = axis == 0 ? m_Bounds.left : m_Bounds.top;
+		float hi = lo + (axis == 0 ? m_Bounds.width : m_Bounds.height);
+
+		if (std::abs(d) < 1e-12f) {
+			if(origin < lo || origin > hi)
+				return NoHitDistance;
+			continue;
+		}
+
+		float t1 = (lo - origin) / d;
+		float t2 = (hi - origin) / d;
+
+		near = std::max(near, std::min(t1, t2));
+		far = std::min(far, std::max(t1, t2));
+
+		if(near > far)
+			return NoHitDistance;
+	}
+
+	//interpolated distance can overestimate by ErrorBound, stepping by the rest never crosses a wall.
+	//Near a wall, passing by and hitting it look the same, so exact trace decides from there
+	const float bound = ErrorBound();
+	const float min_step = m_Resolution * 0.5f;
+	float t = near;
+
+	for (std::size_t step = 0; step < MaxSphereTraceSteps && t <= far; step++) {
+		float safe = Distance(position + dir * t) - bound;
+
+		if(safe < min_step)
+			return t / length;
+
+		t += safe;
+	}
+
+	return t > far ? NoHitDistance : t / length;
+}
+
+WallSDFError WallSDF::MeasureError(const std::vector<Wall>& walls, std::size_t samples)const {
+	WallSDFError error;
+	error.Bound = ErrorBound();
+
+	if(IsEmpty() || !samples)
+		return error;
+
+	RandomGenerator random;
+
+	auto RandomPoint = [&]() {
+		return sf::Vector2f(
+			random.Range(m_Bounds.left, m_Bounds.left + m_Bounds.width),
+			random.Range(m_Bounds.top, m_Bounds.top + m_Bounds.height)
+		);
+	};
+
+	auto ExactTrace = [&walls](sf::Vector2f position, sf::Vector2f direction) {
+		return Wall::TraceNearestObstacleWithNormal(position, direction, walls);
+	};
+
+	double sum = 0;
+	double sensor_sum = 0;
+	double skipped_sum = 0;
+	std::size_t sensor_hits = 0;
+
+	for (std::size_t i = 0; i < samples; i++) {
+		sf::Vector2f point = RandomPoint();
+
+		float difference = std::abs(Distance(point) - ExactDistance(point, walls));
+
+		error.Max = std::max(error.Max, difference);
+		sum += difference;
+
+		float angle = random.Range(0.f, 2.f * 3.14159265f);
+		sf::Vector2f direction(std::cos(angle), std::sin(angle));
+
+		auto exact = ExactTrace(point, direction);
+		auto traced = SphereTrace(point, direction, ExactTrace);
+
+		if ((exact.first < NoHitDistance) != (traced.first < NoHitDistance)) {
+			error.SensorMismatches++;
+			continue;
+		}
+
+		if(exact.first >= NoHitDistance)
+			continue;
+
+		float sensor_difference = std::abs(exact.first - traced.first);
+		error.SensorMax = std::max(error.SensorMax, sensor_difference);
+		sensor_sum += sensor_difference;
+		skipped_sum += exact.first > 0.f ? std::min(SphereTrace(point, direction) / exact.first, 1.f) : 0.f;
+		sensor_hits++;
+	}
+
+	error.Mean = sum / samples;
+	error.SensorMean = sensor_hits ? sensor_sum / sensor_hits : 0.f;
+	error.SkippedFraction = sensor_hits ? skipped_sum / sensor_hits : 0.f;
+
+	return error;
+}
+
+float WallSDF::ErrorBound()const {
+	return m_Resolution * std::sqrt(2.f) / 2.f;
+}
+
+float WallSDF::ExactDistance(sf::Vector2f point, const std::vector<Wall>& walls) {
+	float nearest = std::numeric_limits<float>::infinity();
+
+	for (const auto &wall : walls) {
+		nearest = std::min(nearest, SegmentDistanceSquared(point, sf::Vector2f(wall.Start), sf::Vector2f(wall.End)));
+	}
+
+	return walls.size() ? std::sqrt(nearest) : NoHitDistance;
+}
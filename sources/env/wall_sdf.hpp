@@ -0,0 +1,81 @@
+#pragma once
+
+#include <vector>
+#include <SFML/System/Vector2.hpp>
+#include <SFML/Graphics/Rect.hpp>
+#include "env/wall.hpp"
+
+struct WallSDFError {
+	//measured against exact distance to walls on random points
+	float Max = 0.f;
+	float Mean = 0.f;
+	//guaranteed by interpolation of 1-lipschitz function, Resolution * sqrt(2) / 2
+	float Bound = 0.f;
+
+	//sensor mode against Wall::TraceNearestObstacleWithNormal on random rays, hits and misses should agree
+	float SensorMax = 0.f;
+	float SensorMean = 0.f;
+	std::size_t SensorMismatches = 0;
+	//part of the ray length skipped by sphere tracing, what the exact trace doesn't have to walk
+	float SkippedFraction = 0.f;
+};
+
+//Distance to the nearest wall sampled on a regular grid and bilinearly interpolated.
+//Walls are open segments without inside, so distance is unsigned
+class WallSDF {
+	sf::FloatRect m_Bounds;
+	float m_Resolution = 1.f;
+	sf::Vector2i m_Size;
+	std::vector<float> m_Samples;
+	std::size_t m_WallsCount = 0;
+public:
+	static constexpr std::size_t MaxSphereTraceSteps = 256;
+	//same as the exact traces report for no hit
+	static constexpr float NoHitDistance = 9999999999.f;
+
+	WallSDF() = default;
+
+	//bounds should contain all the walls, resolution is distance between samples in world units
+	WallSDF(const std::vector<Wall> &walls, sf::FloatRect bounds, float resolution);
+
+	float Distance(sf::Vector2f point)const;
+
+	//points away from the nearest wall
+	sf::Vector2f Gradient(sf::Vector2f point)const;
+
+	//how far along direction the ray surely hits nothing, sphere traced until it gets within ErrorBound of some wall.
+	//NoHitDistance when it leaves the bounds before that, in units of direction length
+	float SphereTrace(sf::Vector2f position, sf::Vector2f direction)const;
+
+	//skips empty space with the SDF, exact trace finishes from there, so results are the ones of exact trace
+	template<typename ExactTraceType>
+	std::pair<float, sf::Vector2f> SphereTrace(sf::Vector2f position, sf::Vector2f direction, ExactTraceType ExactTrace)const {
+		const float skipped = SphereTrace(position, direction);
+
+		if(skipped >= NoHitDistance)
+			return {NoHitDistance, {}};
+
+		auto hit = ExactTrace(position + direction * skipped, direction);
+
+		if(hit.first < NoHitDistance)
+			hit.first += skipped;
+
+		return hit;
+	}
+
+	//samples are drawn from a local generator, so measuring doesn't shift the seeded training streams
+	WallSDFError MeasureError(const std::vector<Wall> &walls, std::size_t samples)const;
+
+	bool IsEmpty()const{ return m_Samples.empty(); }
+
+	std::size_t WallsCount()const{ return m_WallsCount; }
+
+	float Resolution()const{ return m_Resolution; }
+
+	float ErrorBound()const;
+
+	static float ExactDistance(sf::Vector2f point, const std::vector<Wall> &walls);
+
+private:
+	float Sample(int x, int y)const{ return m_Samples[y * m_Size.x + x]; }
+};
@@ -0,0 +1,297 @@
+#include "wall_table.hpp"
+#include <cmath>
+#include <limits>
+#include <tuple>
+#include "utils/math.hpp"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+	#define WALL_TABLE_X86 1
+	#if defined(_MSC_VER)
+		#include <intrin.h>
+		#define WALL_TABLE_TARGET_AVX2
+	#else
+		#include <immintrin.h>
+		#define WALL_TABLE_TARGET_AVX2 __attribute__((target("avx2")))
+	#endif
+#else
+	#define WALL_TABLE_X86 0
+#endif
+
+static constexpr float NoHitDistance = 9999999999.f;
+
+//Math::RayLineIntersection compares float against double 0.000001, this is the same test in floats
+static float ParallelThreshold() {
+	float threshold = float(0.000001);
+
+	if(double(threshold) < 0.000001)
+		threshold = std::nextafter(threshold, 1.f);
+
+	return threshold;
+}
+
+static const float s_ParallelThreshold = ParallelThreshold();
+
+WallTable::WallTable(const std::vector<Wall>& walls):
+	m_Count(walls.size())
+{
+	std::size_t padded = (walls.size() + Padding - 1) / Padding * Padding;
+
+	m_StartX.resize(padded, 0.f);
+	m_StartY.resize(padded, 0.f);
+	m_DirectionX.resize(padded, 0.f);
+	m_DirectionY.resize(padded, 0.f);
+	m_NormalX.resize(padded, 0.f);
+	m_NormalY.resize(padded, 0.f);
+
+	for (std::size_t i = 0; i < walls.size(); i++) {
+		auto start = sf::Vector2f(walls[i].Start);
+		auto end = sf::Vector2f(walls[i].End);
+
+		m_StartX[i] = start.x;
+		m_StartY[i] = start.y;
+		m_DirectionX[i] = end.x - start.x;
+		m_DirectionY[i] = end.y - start.y;
+
+		//same as in Math::RayLineIntersectionWithNormal, except sign which depends on ray
+		auto normal = sf::Vector2f(end.y - start.y, start.x - end.x);
+		float length = std::sqrt(normal.x * normal.x + normal.y * normal.y);
+
+		if (length != 0.0f) {
+			normal /= length;
+		}
+
+		m_NormalX[i] = normal.x;
+		m_NormalY[i] = normal.y;
+	}
+}
+
+float WallTable::TraceNearestObstacle(sf::Vector2f position, sf::Vector2f direction)const {
+	auto nearest = FindNearest(position, direction);
+
+	return nearest.Wall >= 0 ? nearest.Distance : NoHitDistance;
+}
+
+std::pair<float, sf::Vector2f> WallTable::TraceNearestObstacleWithNormal(sf::Vector2f position, sf::Vector2f direction)const {
+	return ResolveHit(FindNearest(position, direction), direction);
+}
+
+void WallTable::TraceNearestObstaclesWithNormal(const sf::Vector2f *positions, const sf::Vector2f *directions, std::size_t count, float *distances, sf::Vector2f *normals)const {
+	for (std::size_t i = 0; i < count; i++) {
+		std::tie(distances[i], normals[i]) = ResolveHit(FindNearest(positions[i], directions[i]), directions[i]);
+	}
+}
+
+std::pair<float, sf::Vector2f> WallTable::ResolveHit(Nearest nearest, sf::Vector2f direction)const {
+	if(nearest.Wall < 0)
+		return std::make_pair(NoHitDistance, sf::Vector2f{});
+
+	sf::Vector2f normal(m_NormalX[nearest.Wall], m_NormalY[nearest.Wall]);
+	normal *= -Math::Sign(normal.dot(direction.normalized()));
+
+	return std::make_pair(nearest.Distance, normal);
+}
+
+void WallTable::SetKernel(Kernel kernel) {
+	m_Kernel = std::min(kernel, BestKernel());
+}
+
+WallTable::Kernel WallTable::BestKernel() {
+#if WALL_TABLE_X86
+	static const Kernel best = []() {
+	#if defined(_MSC_VER)
+		int info[4];
+		__cpuid(info, 0);
+		if(info[0] < 7)
+			return Kernel::SSE;
+
+		__cpuid(info, 1);
+		bool os_saves_avx = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) && ((_xgetbv(0) & 6) == 6);
+
+		__cpuidex(info, 7, 0);
+		bool avx2 = info[1] & (1 << 5);
+
+		return os_saves_avx && avx2 ? Kernel::AVX2 : Kernel::SSE;
+	#else
+		__builtin_cpu_init();
+		return __builtin_cpu_supports("avx2") ? Kernel::AVX2 : Kernel::SSE;
+	#endif
+	}();
+
+	return best;
+#else
+	return Kernel::Scalar;
+#endif
+}
+
+const char* WallTable::KernelName(Kernel kernel) {
+	switch (kernel) {
+	case Kernel::SSE:
+		return "SSE";
+	case Kernel::AVX2:
+		return "AVX2";
+	default:
+		return "Scalar";
+	}
+}
+
+WallTable::Nearest WallTable::FindNearest(sf::Vector2f position, sf::Vector2f direction)const {
+	switch (m_Kernel) {
+	case Kernel::SSE:
+		return FindNearestSSE(position, direction);
+	case Kernel::AVX2:
+		return FindNearestAVX2(position, direction);
+	default:
+		return FindNearestScalar(position, direction);
+	}
+}
+
+//operations are done in the same order as in Math::RayLineIntersection so results are bit exact
+WallTable::Nearest WallTable::FindNearestScalar(sf::Vector2f position, sf::Vector2f direction)const {
+	Nearest nearest;
+	float v3x = -direction.y;
+	float v3y = direction.x;
+
+	for (std::size_t i = 0; i < m_Count; i++) {
+		float v1x = position.x - m_StartX[i];
+		float v1y = position.y - m_StartY[i];
+		float v2x = m_DirectionX[i];
+		float v2y = m_DirectionY[i];
+
+		float dot = v2x * v3x + v2y * v3y;
+		if(std::abs(dot) < s_ParallelThreshold)
+			continue;
+
+		float t1 = (v2x * v1y - v2y * v1x) / dot;
+		float t2 = (v1x * v3x + v1y * v3y) / dot;
+
+		if(!(t1 >= 0.f && t2 >= 0.f && t2 <= 1.f))
+			continue;
+
+		if (nearest.Wall < 0 || t1 < nearest.Distance) {
+			nearest.Distance = t1;
+			nearest.Wall = i;
+		}
+	}
+
+	return nearest;
+}
+
+//lanes keep their own nearest, on equal distance the first wall wins like in brute force
+static WallTable::Nearest ReduceLanes(const float *distances, const std::int32_t *walls, std::size_t lanes) {
+	WallTable::Nearest nearest;
+
+	for (std::size_t lane = 0; lane < lanes; lane++) {
+		if(walls[lane] < 0)
+			continue;
+
+		if(nearest.Wall < 0 || distances[lane] < nearest.Distance || (distances[lane] == nearest.Distance && walls[lane] < nearest.Wall))
+			nearest = {distances[lane], walls[lane]};
+	}
+
+	return nearest;
+}
+
+WallTable::Nearest WallTable::FindNearestSSE(sf::Vector2f position, sf::Vector2f direction)const {
+#if WALL_TABLE_X86
+	const __m128 origin_x = _mm_set1_ps(position.x);
+	const __m128 origin_y = _mm_set1_ps(position.y);
+	const __m128 v3x = _mm_set1_ps(-direction.y);
+	const __m128 v3y = _mm_set1_ps(direction.x);
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps(1.f);
+	const __m128 threshold = _mm_set1_ps(s_ParallelThreshold);
+	const __m128 abs_mask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+
+	__m128 best_distance = _mm_set1_ps(std::numeric_limits<float>::infinity());
+	__m128i best_wall = _mm_set1_epi32(-1);
+	__m128i wall = _mm_setr_epi32(0, 1, 2, 3);
+	const __m128i step = _mm_set1_epi32(4);
+
+	for (std::size_t i = 0; i < m_Count; i += 4) {
+		__m128 v1x = _mm_sub_ps(origin_x, _mm_loadu_ps(&m_StartX[i]));
+		__m128 v1y = _mm_sub_ps(origin_y, _mm_loadu_ps(&m_StartY[i]));
+		__m128 v2x = _mm_loadu_ps(&m_DirectionX[i]);
+		__m128 v2y = _mm_loadu_ps(&m_DirectionY[i]);
+
+		__m128 dot = _mm_add_ps(_mm_mul_ps(v2x, v3x), _mm_mul_ps(v2y, v3y));
+		__m128 t1 = _mm_div_ps(_mm_sub_ps(_mm_mul_ps(v2x, v1y), _mm_mul_ps(v2y, v1x)), dot);
+		__m128 t2 = _mm_div_ps(_mm_add_ps(_mm_mul_ps(v1x, v3x), _mm_mul_ps(v1y, v3y)), dot);
+
+		__m128 hit = _mm_cmpge_ps(_mm_and_ps(dot, abs_mask), threshold);
+		hit = _mm_and_ps(hit, _mm_cmpge_ps(t1, zero));
+		hit = _mm_and_ps(hit, _mm_cmpge_ps(t2, zero));
+		hit = _mm_and_ps(hit, _mm_cmple_ps(t2, one));
+		hit = _mm_and_ps(hit, _mm_cmplt_ps(t1, best_distance));
+
+		best_distance = _mm_or_ps(_mm_and_ps(hit, t1), _mm_andnot_ps(hit, best_distance));
+		__m128i hit_int = _mm_castps_si128(hit);
+		best_wall = _mm_or_si128(_mm_and_si128(hit_int, wall), _mm_andnot_si128(hit_int, best_wall));
+
+		wall = _mm_add_epi32(wall, step);
+	}
+
+	alignas(16) float distances[4];
+	alignas(16) std::int32_t walls[4];
+	_mm_store_ps(distances, best_distance);
+	_mm_store_si128((__m128i*)walls, best_wall);
+
+	return ReduceLanes(distances, walls, 4);
+#else
+	return FindNearestScalar(position, direction);
+#endif
+}
+
+#if WALL_TABLE_X86
+WALL_TABLE_TARGET_AVX2 static WallTable::Nearest FindNearestAVX2Impl(const float *start_x, const float *start_y, const float *direction_x, const float *direction_y, std::size_t count, sf::Vector2f position, sf::Vector2f direction, float parallel_threshold) {
+	const __m256 origin_x = _mm256_set1_ps(position.x);
+	const __m256 origin_y = _mm256_set1_ps(position.y);
+	const __m256 v3x = _mm256_set1_ps(-direction.y);
+	const __m256 v3y = _mm256_set1_ps(direction.x);
+	const __m256 zero = _mm256_setzero_ps();
+	const __m256 one = _mm256_set1_ps(1.f);
+	const __m256 threshold = _mm256_set1_ps(parallel_threshold);
+	const __m256 abs_mask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+
+	__m256 best_distance = _mm256_set1_ps(std::numeric_limits<float>::infinity());
+	__m256i best_wall = _mm256_set1_epi32(-1);
+	__m256i wall = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+	const __m256i step = _mm256_set1_epi32(8);
+
+	for (std::size_t i = 0; i < count; i += 8) {
+		__m256 v1x = _mm256_sub_ps(origin_x, _mm256_loadu_ps(start_x + i));
+		__m256 v1y = _mm256_sub_ps(origin_y, _mm256_loadu_ps(start_y + i));
+		__m256 v2x = _mm256_loadu_ps(direction_x + i);
+		__m256 v2y = _mm256_loadu_ps(direction_y + i);
+
+		__m256 dot = _mm256_add_ps(_mm256_mul_ps(v2x, v3x), _mm256_mul_ps(v2y, v3y));
+		__m256 t1 = _mm256_div_ps(_mm256_sub_ps(_mm256_mul_ps(v2x, v1y), _mm256_mul_ps(v2y, v1x)), dot);
+		__m256 t2 = _mm256_div_ps(_mm256_add_ps(_mm256_mul_ps(v1x, v3x), _mm256_mul_ps(v1y, v3y)), dot);
+
+		__m256 hit = _mm256_cmp_ps(_mm256_and_ps(dot, abs_mask), threshold, _CMP_GE_OQ);
+		hit = _mm256_and_ps(hit, _mm256_cmp_ps(t1, zero, _CMP_GE_OQ));
+		hit = _mm256_and_ps(hit, _mm256_cmp_ps(t2, zero, _CMP_GE_OQ));
+		hit = _mm256_and_ps(hit, _mm256_cmp_ps(t2, one, _CMP_LE_OQ));
+		hit = _mm256_and_ps(hit, _mm256_cmp_ps(t1, best_distance, _CMP_LT_OQ));
+
+		best_distance = _mm256_blendv_ps(best_distance, t1, hit);
+		best_wall = _mm256_blendv_epi8(best_wall, wall, _mm256_castps_si256(hit));
+
+		wall = _mm256_add_epi32(wall, step);
+	}
+
+	alignas(32) float distances[8];
+	alignas(32) std::int32_t walls[8];
+	_mm256_store_ps(distances, best_distance);
+	_mm256_store_si256((__m256i*)walls, best_wall);
+
+	return ReduceLanes(distances, walls, 8);
+}
+#endif
+
+WallTable::Nearest WallTable::FindNearestAVX2(sf::Vector2f position, sf::Vector2f direction)const {
+#if WALL_TABLE_X86
+	return FindNearestAVX2Impl(m_StartX.data(), m_StartY.data(), m_DirectionX.data(), m_DirectionY.data(), m_Count, position, direction, s_ParallelThreshold);
+#else
+	return FindNearestScalar(position, direction);
+#endif
+}
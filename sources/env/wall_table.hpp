@@ -0,0 +1,70 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <SFML/System/Vector2.hpp>
+#include "env/wall.hpp"
+
+//Structure of arrays copy of walls for vectorized ray tests, tests one ray against 4/8 walls at once.
+//Gives exactly the same results as Wall::TraceNearestObstacle* brute force versions
+class WallTable {
+public:
+	enum class Kernel {
+		Scalar,
+		SSE,
+		AVX2
+	};
+
+	struct Nearest {
+		float Distance = 0.f;
+		std::int32_t Wall = -1;
+	};
+private:
+
+	//padded up to the widest kernel with zero length walls, they never hit
+	std::vector<float> m_StartX;
+	std::vector<float> m_StartY;
+	std::vector<float> m_DirectionX;
+	std::vector<float> m_DirectionY;
+	std::vector<float> m_NormalX;
+	std::vector<float> m_NormalY;
+	std::size_t m_Count = 0;
+
+	Kernel m_Kernel = BestKernel();
+public:
+	static constexpr std::size_t Padding = 8;
+
+	WallTable() = default;
+
+	WallTable(const std::vector<Wall> &walls);
+
+	float TraceNearestObstacle(sf::Vector2f position, sf::Vector2f direction)const;
+
+	std::pair<float, sf::Vector2f> TraceNearestObstacleWithNormal(sf::Vector2f position, sf::Vector2f direction)const;
+
+	//same as calling TraceNearestObstacleWithNormal for every ray
+	void TraceNearestObstaclesWithNormal(const sf::Vector2f *positions, const sf::Vector2f *directions, std::size_t count, float *distances, sf::Vector2f *normals)const;
+
+	std::size_t WallsCount()const{ return m_Count; }
+
+	//falls back to the best supported one
+	void SetKernel(Kernel kernel);
+
+	Kernel UsedKernel()const{ return m_Kernel; }
+
+	//widest kernel supported by cpu we are running on
+	static Kernel BestKernel();
+
+	static const char *KernelName(Kernel kernel);
+
+private:
+	Nearest FindNearest(sf::Vector2f position, sf::Vector2f direction)const;
+
+	Nearest FindNearestScalar(sf::Vector2f position, sf::Vector2f direction)const;
+
+	Nearest FindNearestSSE(sf::Vector2f position, sf::Vector2f direction)const;
+
+	Nearest FindNearestAVX2(sf::Vector2f position, sf::Vector2f direction)const;
+
+	std::pair<float, sf::Vector2f> ResolveHit(Nearest nearest, sf::Vector2f direction)const;
+};
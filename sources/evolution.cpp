@@ -6,10 +6,14 @@
 #include "agents/manual.hpp"
 #include "utils/imgui.hpp"
 #include "utils/math.hpp"
+#include "utils/nn_trainer.hpp"
+#include "utils/nn_quantized.hpp"
+#include "utils/model_file.hpp"
 #include <iostream>
 #include <sstream>
 #include <filesystem>
 #include <random>
+#include <future>
 #include <bsl/file.hpp>
 #include <bsl/log.hpp>
 #include <sfpl.hpp>
@@ -21,6 +25,10 @@ private:
 
 	bool m_IsPaused = false;
 	bool m_IsDebug = false;
+	int m_Threads = 0;
+
+	//measurement owns m_Evo until it is ready, training is neither ticked nor drawn meanwhile
+	std::future<std::vector<Scaling>> m_Scaling;
 public:
 	EvolutionTrainingApp(sf::Vector2i size, const std::string &best, const std::string &map):
 		Super(size),
@@ -28,6 +36,7 @@ public:
 	{
 		m_View.zoom(2);
 		m_Window.setFramerateLimit(1000);
+		m_Threads = m_Evo.ThreadsCount();
 	}
 
 	virtual void Tick(float dt) override{
@@ -35,7 +44,7 @@ public:
 
 		int num_per_frame = 400;
 
-		if(m_IsPaused)
+		if(m_IsPaused || IsMeasuringScaling())
 			return;
 
 		for (int i = 0; i < num_per_frame; i++) {
@@ -46,17 +55,43 @@ public:
 	void OnImGui()override {
 		
 		ImGui::Begin("Training");
+
+		if (m_Scaling.valid() && m_Scaling.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+			for (const auto &scaling : m_Scaling.get()) {
+				Println("Threads: %, AgentSteps/sec: %, Efficiency: %", scaling.Threads, scaling.ItemsPerSecond, scaling.Efficiency);
+			}
+		}
+
+		if (IsMeasuringScaling()) {
+			ImGui::Text("Measuring scaling...");
+			ImGui::End();
+			return;
+		}
 		
 		if(ImGui::Button("SaveBest"))
 			m_Evo.SaveBest();
 
+		if(ImGui::SliderInt("Threads", &m_Threads, 1, (int)WorkerPool::HardwareThreads()))
+			m_Evo.SetThreadsCount(m_Threads);
+
+		if (ImGui::Button("MeasureScaling")) {
+			m_Scaling = std::async(std::launch::async, [this]() {
+				return m_Evo.MeasureScaling(1.f / 60 / 400);
+			});
+		}
+
 		ImGui::End();
 	}
 
+	bool IsMeasuringScaling()const {
+		return m_Scaling.valid();
+	}
+
 	virtual void Render(sf::RenderTarget& rt) override{
 		Super::Render(rt);
 
-		m_Evo.Draw(rt, m_IsDebug);
+		if(!IsMeasuringScaling())
+			m_Evo.Draw(rt, m_IsDebug);
 	}
 };
 
@@ -66,10 +101,13 @@ private:
 	VacuumCleanerOperator m_Cleaner;
 	Environment m_Env;
 public:
-	EvolutionDemoApp(sf::Vector2i size):
+	//quantized model made by QuantizeNeuralNetwork from the same network runs instead of the float one
+	EvolutionDemoApp(sf::Vector2i size, std::optional<std::string> quantized_path = std::nullopt):
 		Super(size)
 	{
 		m_Cleaner.Agent().LoadFromFile("best13/1.bin");
+		if(quantized_path.has_value() && !m_Cleaner.Agent().LoadQuantizedFromFile(quantized_path.value()))
+			Println("Can't load quantized network from '%', float one is used", quantized_path.value());
 		m_Env.LoadFromFile("room1.map");
 		m_Window.setFramerateLimit(60);
 		m_View.zoom(2);
@@ -109,19 +147,103 @@ void TrainNeuralNetwork(const char *dataset_path) {
 	);
 	int EpochCount = 5;	
 	float Rate = 0.3;
+	std::size_t BatchSize = 128;
+
+	for (const auto &scaling : ParallelTrainer::MeasureScaling(nn, dataset, Rate, 0, BatchSize)) {
+		Println("Threads: %, Samples/sec: %, Efficiency: %", scaling.Threads, scaling.ItemsPerSecond, scaling.Efficiency);
+	}
+
+	ParallelTrainer trainer(0, BatchSize);
 
 	for(int i = 0; i<EpochCount; i++){
-		float value = nn.Backpropagation(dataset, Rate);
+		TrainingReport report = trainer.Epoch(nn, dataset, Rate);
 
-		Println("Epoch: %, Value: %", i, value);
+		Println("Epoch: %, Value: %, Samples/sec: %", i, report.Error, report.SamplesPerSecond());
 	}
 	
 }
 
-int main(){
-	srand(time(0));
+void QuantizeNeuralNetwork(const char *model_path, const char *dataset_path, const char *output_path) {
+	std::fstream model(model_path, std::ios::binary | std::ios::in);
+	auto nn = Serializer<NeuralNetwork>::FromStream(model);
+
+	if (!nn.has_value()) {
+		Println("Can't load network from '%'", model_path);
+		return;
+	}
+
+	std::fstream file(dataset_path, std::ios::binary | std::ios::in);
+
+	std::vector<std::pair<VacuumCleanerState, sf::Vector2f>> data;
+	data = Serializer<decltype(data)>::FromStream(file).value_or(data);
+
+	QuantizedNetwork::Dataset dataset;
+	dataset.reserve(data.size());
+	for (auto& [state, move] : data) {
+		dataset.emplace_back(NeuralNetworkAgent::StateToMatrix(state), NeuralNetworkAgent::MoveToMatrix(move));
+	}
+
+	QuantizedNetwork quantized = QuantizedNetwork::Quantize(nn.value(), dataset);
+	QuantizationReport report = QuantizedNetwork::Evaluate(nn.value(), quantized, dataset);
+
+	Println("Samples: %, MaxError: %, MeanError: %", report.Samples, report.MaxError, report.MeanError);
+	Println("FloatLoss: %, QuantizedLoss: %, Speedup: %", report.FloatLoss, report.QuantizedLoss, report.Speedup());
+
+	std::fstream output(output_path, std::ios::binary | std::ios::out);
+	Serializer<QuantizedNetwork>::ToStream(quantized, output);
+}
+
+//agents of best.mod go to a mappable model file as "agents/<index>"
+void ExportModels(const char *best_path, const char *output_path) {
+	std::fstream best(best_path, std::ios::binary | std::ios::in);
+
+	Serializer<std::size_t>::FromStream(best);
+	Serializer<std::size_t>::FromStream(best);
+	Serializer<std::size_t>::FromStream(best);
+	Serializer<float>::FromStream(best);
+	auto agents = Serializer<std::vector<NeuralNetworkAgent>>::FromStream(best);
+
+	if (!agents.has_value()) {
+		Println("Can't load agents from '%'", best_path);
+		return;
+	}
+
+	ModelWriter writer;
+	for (std::size_t i = 0; i < agents->size(); i++) {
+		if (!writer.Add("agents/" + std::to_string(i), agents.value()[i].Network())) {
+			Println("Agent % names don't fit model file", i);
+			return;
+		}
+	}
+
+	if(!writer.Save(output_path))
+		Println("Can't save models to '%'", output_path);
+	else
+		Println("Exported % agents, % tensors", agents->size(), writer.Count());
+}
+
+int main(int argc, char **argv){
+	RandomGenerator::SetSeed(time(0));
 
 	std::filesystem::current_path("../../../run_tree");
 
+	//paths are relative to run_tree
+	const std::vector<std::string> args(argv + 1, argv + argc);
+
+	if (args.size() == 4 && args[0] == "quantize") {
+		QuantizeNeuralNetwork(args[1].c_str(), args[2].c_str(), args[3].c_str());
+		return 0;
+	}
+
+	if (args.size() == 3 && args[0] == "export") {
+		ExportModels(args[1].c_str(), args[2].c_str());
+		return 0;
+	}
+
+	if (args.size() && args[0] == "demo") {
+		EvolutionDemoApp({1920, 1080}, args.size() > 1 ? std::make_optional(args[1]) : std::nullopt).Run();
+		return 0;
+	}
+
 	EvolutionTrainingApp({1920, 1080}, "best.mod", "room1_with_path.map").Run();
 }
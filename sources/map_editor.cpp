@@ -25,6 +25,14 @@ MapEditor::MapEditor(sf::Vector2i world_size):
 void MapEditor::Tick(float dt) {
 	Super::Tick(dt);
 
+	if (m_PathGenerator) {
+		for(auto point: m_PathGenerator->Resume(sf::milliseconds(m_PathBuildingTimeSlice)))
+			m_Env.Path.push_back(point + m_Env.Grid.Bounds.getPosition());
+
+		if(m_PathGenerator->IsFinished() || m_PathGenerator->IsCancelled())
+			m_PathGenerator.reset();
+	}
+
 	if(sf::Keyboard::isKeyPressed(sf::Keyboard::Key::LControl))
 		return;
 
@@ -86,8 +94,13 @@ void MapEditor::OnImGui() {
 	if(ImGui::Button("Clear Zones"))
 		m_Env.ZonesToClean.clear();
 
-	if(ImGui::Button("Clear"))
+	if(ImGui::Button("Clear Additional Starts"))
+		m_Env.AdditionalStartPositions.clear();
+
+	if (ImGui::Button("Clear")) {
+		m_PathGenerator.reset();
 		m_Env.Clear();
+	}
 
 
 	ImGui::InputText("Filename", m_MapFilename);
@@ -103,6 +116,7 @@ void MapEditor::OnImGui() {
 			continue;
 
 		if (ImGui::Button(file.path().string().c_str())) {
+			m_PathGenerator.reset();
 			m_Env.Clear();
 			m_Env.LoadFromFile(file.path().string());
 			m_MapFilename = file.path().stem().string();
@@ -116,20 +130,92 @@ void MapEditor::OnImGui() {
 	ImGui::Checkbox("Draw Grid Decomposition", &m_DrawGridDecomposition);
 	ImGui::InputInt("Grid Cell Size", &m_GridCellSize);
 	
+	ImGui::Checkbox("Use Walls BVH", &m_Env.UseWallsBVH);
+	if (ImGui::Button("Validate Walls BVH")) {
+		m_Env.RebuildWallsBVH();
+
+		std::vector<std::pair<sf::Vector2f, sf::Vector2f>> rays;
+		auto bounds = m_Env.GatherBounds();
+		for (int x = bounds.left; x < bounds.left + bounds.width; x += m_SnapGrid) {
+			for (int y = bounds.top; y < bounds.top + bounds.height; y += m_SnapGrid) {
+				for(int angle = 0; angle < 360; angle += 15)
+					rays.push_back({sf::Vector2f(x, y), Math::RotationToDirection(angle)});
+			}
+		}
+		m_WallsBVHMismatches = m_Env.WallsBVH.Validate(rays);
+	}
+	if(m_WallsBVHMismatches.has_value())
+		ImGui::Text("Walls BVH mismatches: %d", (int)m_WallsBVHMismatches.value());
+
+	if(ImGui::InputFloat("Walls SDF Resolution", &m_Env.WallsSDFResolution))
+		m_Env.WallsSDFResolution = std::max(1.f, m_Env.WallsSDFResolution);
+	ImGui::Checkbox("Use Walls SDF Crashes", &m_Env.UseWallsSDFCrashes);
+	ImGui::Checkbox("Use Walls SDF Sensors", &m_Env.UseWallsSDFSensors);
+	if (ImGui::Button("Measure Walls SDF Error")) {
+		m_Env.RebuildWallsSDF();
+		m_WallsSDFError = m_Env.WallsSDF.MeasureError(m_Env.Walls, 100000);
+	}
+	if (m_WallsSDFError.has_value()) {
+		ImGui::Text("Walls SDF error: max %.3f, mean %.3f, bound %.3f", m_WallsSDFError->Max, m_WallsSDFError->Mean, m_WallsSDFError->Bound);
+		ImGui::Text("Walls SDF sensors error: max %.3f, mean %.3f, mismatches %d, skipped %.1f%%", m_WallsSDFError->SensorMax, m_WallsSDFError->SensorMean, (int)m_WallsSDFError->SensorMismatches, m_WallsSDFError->SkippedFraction * 100.f);
+	}
+
 	ImGui::Spacing();
 	ImGui::Checkbox("Optimized Graph", &m_OptimizedGraph);
-	if (ImGui::Button("Bake"))
+	if (ImGui::Button("Bake")) {
+		m_PathGenerator.reset();
 		m_Env.Bake(m_GridCellSize, m_OptimizedGraph);
+	}
 	
 	std::vector<std::string> names;
 	for(const auto &builder: m_Builders)
 		names.push_back(builder->Name());
 
 	ImGui::SimpleCombo("Path Builder", &m_Current, names);
+	ImGui::Checkbox("Time Optimal Path", &m_Builders[m_Current]->TimeOptimal);
+	//0 would mean run to completion and freeze the editor
+	if(ImGui::InputInt("Path Building Time Slice (ms)", &m_PathBuildingTimeSlice))
+		m_PathBuildingTimeSlice = std::max(m_PathBuildingTimeSlice, 1);
 	if(ImGui::Button("Build Path")){
-		m_Env.Path = m_Builders[m_Current]->MakePath(m_Env, m_Env.StartPosition - m_Env.Grid.Bounds.getPosition());
-		for(auto &point: m_Env.Path)
-			point += m_Env.Grid.Bounds.getPosition();
+		m_Env.Path.clear();
+		m_PathGenerator = m_Builders[m_Current]->MakeGenerator(m_Env, m_Env.StartPosition - m_Env.Grid.Bounds.getPosition());
+	}
+
+	if (m_PathGenerator) {
+		ImGui::Text("Building Path: %d points", (int)m_PathGenerator->Path().size());
+		if(ImGui::Button("Cancel Path Building"))
+			m_PathGenerator->Cancel();
+	}
+
+	ImGui::Text("Robots: %d", (int)m_Env.StartPositions().size());
+	if(ImGui::Button("Build Multi Robot Plan"))
+		m_MultiRobotPlan = MultiRobotPlanner(m_Env).MakePlan(*m_Builders[m_Current]);
+
+	if (m_MultiRobotPlan.has_value()) {
+		const auto &plan = m_MultiRobotPlan.value();
+
+		ImGui::Text("Makespan: %.1f seconds", plan.Makespan);
+		for(int i = 0; i<plan.Paths.size(); i++)
+			ImGui::Text("Robot %d: estimated %.1f, path %.1f seconds", i, plan.RegionCosts[i], plan.PathTimes[i]);
+
+		if(ImGui::Button("Clear Multi Robot Plan"))
+			m_MultiRobotPlan.reset();
+	}
+
+	if(ImGui::Button("Evaluate Path Coverage"))
+		m_CoverageReport = PathCoverageEvaluator(m_Env).Evaluate(m_Env.Path, m_Env.ZonesToClean);
+
+	ImGui::Text("Estimated Path Time: %.1f seconds", EstimatePathTime(m_Env.Path));
+
+	if (m_CoverageReport.has_value()) {
+		const auto &report = m_CoverageReport.value();
+
+		ImGui::Text("Covered: %.1f%%", report.Covered * 100);
+		ImGui::Text("Overlap: %.1f%%", report.Overlap * 100);
+		ImGui::Text("Missed Regions: %d", (int)report.MissedRegions.size());
+		for(int i = 0; i<report.ZonesCoverage.size(); i++)
+			ImGui::Text("Zone %d Covered: %.1f%%", i, report.ZonesCoverage[i] * 100);
+		ImGui::Checkbox("Draw Missed Regions", &m_DrawMissedRegions);
 	}
 
 	ImGui::Separator();
@@ -175,6 +261,20 @@ void MapEditor::Render(sf::RenderTarget& rt) {
 		m_Env.DrawGraph(rt, m_DrawCoverageGraphDirecions, WorldMousePosition());
 	m_Env.Draw(rt, m_PathDrawingMode, m_DrawCleanZones);
 
+	if (m_MultiRobotPlan.has_value()) {
+		const auto &paths = m_MultiRobotPlan->Paths;
+
+		for (int i = 0; i < paths.size(); i++) {
+			for(int j = 1; j < paths[i].size(); j++)
+				Render::DrawLine(rt, paths[i][j - 1], paths[i][j], 3.f, Render::GetRainbowColor(i, paths.size()));
+		}
+	}
+
+	if (m_DrawMissedRegions && m_CoverageReport.has_value()) {
+		for(auto region: m_CoverageReport->MissedRegions)
+			Render::DrawRect(rt, region, sf::Color::Red * sf::Color(255, 255, 255, 60), 1, sf::Color::Red);
+	}
+
 	
 	if(m_Tool == EditTool::Wall){
 		if (m_ToolCache.has_value()) {
@@ -216,12 +316,17 @@ void MapEditor::OnEvent(const sf::Event& e){
 			if(m_Tool == EditTool::Start){
 				m_Env.StartPosition = WorldMousePosition();
 			}
+
+			if(m_Tool == EditTool::AdditionalStart){
+				m_Env.AdditionalStartPositions.push_back(WorldMousePosition());
+			}
 		}
 
 		if (const auto *mouse = e.getIf<sf::Event::MouseButtonReleased>()){
 			if(m_Tool == EditTool::Wall){
 				if(mouse->button == sf::Mouse::Button::Right && m_ToolCache.has_value()){
 					m_Env.Walls.push_back({m_ToolCache.value(), MakeEndPoint()});
+					m_Env.InvalidateWallsAccelerators();
 				}
 			}
 
@@ -246,7 +351,10 @@ void MapEditor::OnEvent(const sf::Event& e){
 		}
 #if !EDITOR_WITH_PATH
 		if (key->code == sf::Keyboard::Key::Z && sf::Keyboard::isKeyPressed(sf::Keyboard::Key::LControl)) {
-			m_Env.Walls.pop_back();
+			if (m_Env.Walls.size()) {
+				m_Env.Walls.pop_back();
+				m_Env.InvalidateWallsAccelerators();
+			}
 		}
 #endif
 	}
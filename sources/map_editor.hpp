@@ -6,16 +6,19 @@
 #include "model/vacuum_cleaner.hpp"
 #include "application.hpp"
 #include "env/path.hpp"
+#include "env/path_coverage.hpp"
+#include "env/multi_robot.hpp"
 
 enum class EditTool: std::size_t{
 	Wall = 0,
 	Zone = 1,
 	Start = 2,
-	Path = 3
+	Path = 3,
+	AdditionalStart = 4
 };
 
 inline std::vector<std::string> EditToolMembers() {
-	return {"Wall", "Zone", "Start Placement", "Path"};
+	return {"Wall", "Zone", "Start Placement", "Path", "Additional Start Placement"};
 }
 
 class MapEditor: public ZoomMoveApplication{
@@ -55,6 +58,17 @@ private:
 	std::vector<std::unique_ptr<PathBuilder>> m_Builders;
 	std::size_t m_Current = 0;
 
+	std::unique_ptr<PathGenerator> m_PathGenerator;
+	int m_PathBuildingTimeSlice = 8;
+
+	std::optional<PathCoverageReport> m_CoverageReport;
+	bool m_DrawMissedRegions = false;
+
+	std::optional<MultiRobotPlan> m_MultiRobotPlan;
+
+	std::optional<std::size_t> m_WallsBVHMismatches;
+	std::optional<WallSDFError> m_WallsSDFError;
+
 	EditTool m_Tool = EditTool::Wall;
 public:
 
@@ -0,0 +1,58 @@
+#include <chrono>
+#include <string>
+#include <bsl/log.hpp>
+#include "utils/random.hpp"
+#include "utils/matrix.hpp"
+
+//the implementation Matrix had before kernels, kept as the baseline
+static Matrix<float> MultiplyNaive(const Matrix<float> &a, const Matrix<float> &b) {
+	Matrix<float> result(a.N(), b.M());
+
+	for (size_t i = 0; i < a.N(); ++i) {
+		for (size_t j = 0; j < b.M(); ++j) {
+			float sum = 0;
+			for (size_t k = 0; k < a.M(); ++k) {
+				sum += a[i][k] * b[k][j];
+			}
+			result[i][j] = sum;
+		}
+	}
+
+	return result;
+}
+
+template<typename FunctionType>
+static double MeasureMicroseconds(std::size_t repeats, FunctionType function) {
+	auto begin = std::chrono::steady_clock::now();
+
+	for (std::size_t i = 0; i < repeats; i++) {
+		function();
+	}
+
+	auto end = std::chrono::steady_clock::now();
+	return std::chrono::duration<double, std::micro>(end - begin).count() / repeats;
+}
+
+static void Benchmark(const std::string &name, std::size_t n, std::size_t k, std::size_t m, std::size_t repeats) {
+	auto a = Matrix<float>::Random(n, k, -1, 1);
+	auto b = Matrix<float>::Random(k, m, -1, 1);
+
+	float sink = 0;
+	double naive = MeasureMicroseconds(repeats, [&]() { sink += MultiplyNaive(a, b).Data()[0]; });
+	double kernel = MeasureMicroseconds(repeats, [&]() { sink += (a * b).Data()[0]; });
+
+	bool exact = MultiplyNaive(a, b) == a * b;
+
+	Println("%: %x% * %x%, naive % us, kernel % us, speedup %x, bit exact %, (%)", name, n, k, k, m, naive, kernel, naive / kernel, exact, sink);
+}
+
+int main() {
+	//topology used by NeuralNetworkAgent
+	Benchmark("GEMV layer", 1, 8, 32, 200000);
+	Benchmark("GEMV layer", 1, 32, 20, 200000);
+	Benchmark("GEMV wide", 1, 512, 512, 2000);
+
+	Benchmark("GEMM population", 64, 32, 20, 20000);
+	Benchmark("GEMM square", 256, 256, 256, 20);
+	Benchmark("GEMM square", 512, 512, 512, 3);
+}
@@ -6,9 +6,11 @@
 #include "bsl/format.hpp"
 #include "bsl/defer.hpp"
 #include "config.hpp"
+#include <chrono>
 
 EvolutionTraining::EvolutionTraining(const std::string &best_path, const std::string &map_path):
-	m_BestPath(best_path)
+	m_BestPath(best_path),
+	m_Pool(std::make_unique<WorkerPool>(EvolutionThreads))
 {
 	m_Env.LoadFromFile(map_path);
 
@@ -22,6 +24,8 @@ EvolutionTraining::EvolutionTraining(const std::string &best_path, const std::st
 		for (auto& p : m_Population) {
 			p.Reset(m_Env, (sf::Vector2f)m_Env.StartPosition);
 		}
+
+		RebuildPopulationNetwork();
 	};
 	
 	std::fstream best(best_path, std::ios::binary | std::ios::in);
@@ -47,11 +51,16 @@ EvolutionTraining::EvolutionTraining(const std::string &best_path, const std::st
 			m_Population.back().Iterate(m_Env, 0, 0);
 		}
 		
-		m_Population = PopulationFromSorted(m_Population);
+		PopulationFromSorted(m_Population, m_NextPopulation);
+		std::swap(m_Population, m_NextPopulation);
+		Recycle(m_NextPopulation);
 	}
 }
 
 void EvolutionTraining::Tick(float dt) {
+	const auto tick_begin = std::chrono::steady_clock::now();
+	const size_t steps = m_Population.size();
+
 	m_IterationsNumber++;
 
 	SortPopulation();
@@ -75,34 +84,152 @@ void EvolutionTraining::Tick(float dt) {
 	}
 
 
-	std::vector<int> die;
-	
-	for (int i = 0; i<m_Population.size(); i++) {
-		VacuumCleanerOperator &agent = m_Population[i];
+	StepAgents(dt);
 
-		agent.Iterate(m_Env, dt, m_IterationsNumber);
+	m_Dying.clear();
 
-		if(agent.StandStill() > StandStillToDie || agent.NumberFailure() || agent.HasCrashed(m_Env) || agent.Agent().HasNotTraveled() || agent.Agent().TooFarGone())
-			die.push_back(i);
+	for (int i = 0; i<m_Population.size(); i++) {
+		if(m_Dead[i])
+			m_Dying.push_back(i);
 	}
 
-	if (die.size() > 2 && die.size() + 2 >= m_Population.size()) {
-		die.pop_back();
-		die.pop_back();
+	if (m_Dying.size() > 2 && m_Dying.size() + 2 >= m_Population.size()) {
+		m_Dying.pop_back();
+		m_Dying.pop_back();
 	}
 
-	for (int i = die.size() - 1; i>=0; i--) {
+	for (int i = m_Dying.size() - 1; i>=0; i--) {
 		if(m_Population.size() <= 2)
 			break;
 
-		int index = die[i];
+		int index = m_Dying[i];
 		std::swap(m_Population[index], m_Population.back());
+		m_Recycled.push_back(std::move(m_Population.back()));
 		m_Population.pop_back();
 	}
 
 	if (m_Population.size() == 2 || m_IterationsNumber % ((m_HighestGoal + 1) * IterationsPerGoal) == 0) {
 		NextGeneration();
 	}
+
+	m_StepsCounted += steps;
+	m_StepsTime += std::chrono::duration<double>(std::chrono::steady_clock::now() - tick_begin).count();
+
+	if (m_StepsTime >= 1.0) {
+		m_StepsPerSecond = m_StepsCounted / m_StepsTime;
+		m_StepsCounted = 0;
+		m_StepsTime = 0;
+	}
+}
+
+void EvolutionTraining::StepAgents(float dt) {
+	const size_t count = m_Population.size();
+	const size_t blocks = (count + AgentsBlock - 1) / AgentsBlock;
+
+	m_Cleaners.clear();
+	for (auto &agent : m_Population)
+		m_Cleaners.push_back(&agent.Cleaner());
+
+	m_Sensors.Resize(count, VacuumCleaner::Sensors.size());
+	m_States.resize(count);
+	m_Observed.assign(count, false);
+	m_Dead.assign(count, false);
+	m_BlockCacheHits.assign(blocks, 0);
+
+	//every agent touches only its own state and its rows of shared buffers, agents cost differs a lot so blocks are stolen.
+	//Captures are kept small enough for std::function to store them inline, so a tick does not allocate
+	m_Pool->ParallelFor(blocks, 1, [this, dt](size_t block, size_t worker) {
+		const size_t begin = block * AgentsBlock;
+		const size_t end = std::min(begin + AgentsBlock, m_Population.size());
+
+		m_BlockCacheHits[block] = VacuumCleaner::TraceSensors(m_Cleaners, m_Env, m_Sensors, begin, end);
+
+		for (size_t i = begin; i < end; i++) {
+			VacuumCleanerOperator &agent = m_Population[i];
+
+			if (agent.Slot() == VacuumCleanerOperator::NoSlot) {
+				agent.Iterate(m_Env, dt, m_IterationsNumber, m_Sensors.State(i));
+				continue;
+			}
+
+			m_Observed[i] = agent.Observe(m_Env, m_IterationsNumber, m_Sensors.State(i), m_States[i]);
+
+			if (m_Observed[i]) {
+				//population input is a small fixed size row, state is written straight into it
+				float input[CleanerSensorsCount + 2];
+				NeuralNetworkAgent::StateToInput(m_States[i], input);
+				m_PopulationNetwork.SetInput(agent.Slot(), input);
+			}
+		}
+	});
+
+	if (m_Env.CanUseSensorsCache()) {
+		for (size_t hits : m_BlockCacheHits)
+			m_Sensors.CacheHits += hits;
+		m_Sensors.CacheLookups += m_Sensors.Origins.size();
+	}
+
+	m_PopulationNetwork.Do(*m_Pool);
+
+	m_Pool->ParallelFor(blocks, 1, [this, dt](size_t block, size_t worker) {
+		const size_t begin = block * AgentsBlock;
+		const size_t end = std::min(begin + AgentsBlock, m_Population.size());
+
+		for (size_t i = begin; i < end; i++) {
+			VacuumCleanerOperator &agent = m_Population[i];
+			const size_t slot = agent.Slot();
+
+			if (slot != VacuumCleanerOperator::NoSlot) {
+				if(m_Observed[i])
+					agent.Act(m_Env, dt, m_States[i], {m_PopulationNetwork.Output(slot, 0), m_PopulationNetwork.Output(slot, 1)});
+				else
+					agent.Idle(dt);
+			}
+
+			m_Dead[i] = agent.StandStill() > StandStillToDie || agent.NumberFailure() || agent.HasCrashed(m_Env) || agent.Agent().HasNotTraveled() || agent.Agent().TooFarGone();
+		}
+	});
+}
+
+void EvolutionTraining::SetThreadsCount(size_t threads) {
+	if(!threads)
+		threads = WorkerPool::HardwareThreads();
+
+	if(threads != m_Pool->Size())
+		m_Pool = std::make_unique<WorkerPool>(threads);
+}
+
+std::vector<Scaling> EvolutionTraining::MeasureScaling(float dt, size_t max_threads, size_t ticks) {
+	if(!max_threads)
+		max_threads = WorkerPool::HardwareThreads();
+
+	const size_t threads_count = ThreadsCount();
+	const size_t cache_hits = m_Sensors.CacheHits;
+	const size_t cache_lookups = m_Sensors.CacheLookups;
+
+	//genomes are not changed by steps, so packed population network stays valid for every run
+	const std::vector<VacuumCleanerOperator> snapshot = m_Population;
+
+	std::vector<Scaling> scaling;
+
+	for (size_t threads = 1; threads <= max_threads; threads *= 2) {
+		SetThreadsCount(threads);
+		std::copy(snapshot.begin(), snapshot.end(), m_Population.begin());
+
+		const auto begin = std::chrono::steady_clock::now();
+		for (size_t i = 0; i < ticks; i++)
+			StepAgents(dt);
+		const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+		AppendScaling(scaling, threads, seconds > 0 ? ticks * m_Population.size() / seconds : 0);
+	}
+
+	std::copy(snapshot.begin(), snapshot.end(), m_Population.begin());
+	SetThreadsCount(threads_count);
+	m_Sensors.CacheHits = cache_hits;
+	m_Sensors.CacheLookups = cache_lookups;
+
+	return scaling;
 }
 
 void EvolutionTraining::NextGeneration() {
@@ -114,23 +241,29 @@ void EvolutionTraining::NextGeneration() {
 	Println("BestOfEachGoal: %", m_BestOfEachGoal.size());
 	
 	for (const auto &best : m_BestOfEachGoal) {
-		m_Population.push_back(best);
-		m_Population.back().Iterate(m_Env, 0, 0);
+		VacuumCleanerOperator &op = AppendRecycled(m_Population);
+		op = best;
+		op.Iterate(m_Env, 0, 0);
+	}
+	for (const auto &best : m_BestOfEachGoal) {
+		AppendRecycled(m_Population) = best;
 	}
-	std::copy(m_BestOfEachGoal.begin(), m_BestOfEachGoal.end(), std::back_inserter(m_Population));
 
 	SortPopulation();
 
 	assert(m_Population[0].FitnessFunction(m_Env) >= m_Population[1].FitnessFunction(m_Env));
 
-	auto new_population = PopulationFromSorted(m_Population);
+	PopulationFromSorted(m_Population, m_NextPopulation);
 
-	std::cout << "New Generation: " << m_Generation << " size " << new_population.size() << " from " << m_Population.size() << "\n";
+	std::cout << "New Generation: " << m_Generation << " size " << m_NextPopulation.size() << " from " << m_Population.size() << "\n";
 
-	m_Population = std::move(new_population);
+	std::swap(m_Population, m_NextPopulation);
+	Recycle(m_NextPopulation);
 
 	for (auto& p : m_Population)
 		p.Reset(m_Env, sf::Vector2f(m_Env.StartPosition));
+
+	RebuildPopulationNetwork();
 }
 
 void EvolutionTraining::SortPopulation() {
@@ -139,37 +272,80 @@ void EvolutionTraining::SortPopulation() {
 	});
 }
 
-std::vector<VacuumCleanerOperator> EvolutionTraining::PopulationFromSorted(const std::vector<VacuumCleanerOperator> &population) {
-	std::vector<VacuumCleanerOperator> new_population;
+void EvolutionTraining::RebuildPopulationNetwork() {
+	m_Networks.clear();
+
+	for (auto &agent : m_Population) {
+		const NeuralNetwork &network = agent.Agent().Network();
+
+		//population input is filled from the fixed size state
+		bool compatible = network.Layers().size() && network.Layers().front().Weights().N() == CleanerSensorsCount + 2 && network.Layers().back().Weights().M() >= 2;
+
+		if (compatible && (m_Networks.empty() || PopulationNetwork::IsCompatible(*m_Networks.front(), network))) {
+			agent.SetSlot(m_Networks.size());
+			m_Networks.push_back(&network);
+		} else {
+			agent.SetSlot(VacuumCleanerOperator::NoSlot);
+		}
+	}
+
+	m_PopulationNetwork.Build(m_Networks);
+}
+
+void EvolutionTraining::PopulationFromSorted(const std::vector<VacuumCleanerOperator> &population, std::vector<VacuumCleanerOperator> &new_population) {
+	const size_t begin = new_population.size();
 
 	auto count = std::min(ModelsToCrossover, population.size());
 	for (int i = 0; i < count; i++) {
 		for (int j = 0; j < count; j++) {
-			new_population.push_back(VacuumCleanerOperator::Crossover(population[i], population[j]));
+			VacuumCleanerOperator::Crossover(population[i], population[j], AppendRecycled(new_population));
 		}
 	}
 
-	for (auto& op : new_population) {
+	for (size_t i = begin; i < new_population.size(); i++) {
+		VacuumCleanerOperator &op = new_population[i];
+
 		if (GetRandom<float>(0, 1) < GenofondMutationChance)
-			op = VacuumCleanerOperator::Mutate(op, MutationChance, MutationRange);
+			VacuumCleanerOperator::Mutate(op, MutationChance, MutationRange, op);
 		op.Reset(m_Env, sf::Vector2f(m_Env.StartPosition));
 	}
 
 	for(int i = 0; i<count; i++){
-		new_population.push_back(population[i]);
+		AppendRecycled(new_population) = population[i];
 	}
 
 	for (int i = 0; i < RandomCrossovers; i++) {
-		new_population.push_back(VacuumCleanerOperator::Crossover({}, new_population[rand() % new_population.size()]));
+		m_RandomGenome.Agent().Randomize();
+
+		const size_t second = begin + RandomGenerator::ThisThread().Below(new_population.size() - begin);
+		VacuumCleanerOperator &child = AppendRecycled(new_population);
+		VacuumCleanerOperator::Crossover(m_RandomGenome, new_population[second], child);
 	}
 
 	for (int i = 0; i < std::min(BestModelsToMutate, population.size()); i++) {
 		for(int j = 0; j<BestModelsMutateTimes; j++){
-			new_population.push_back(VacuumCleanerOperator::Mutate(population[i], BestModelsToMutationChance, BestModelsToMutationRange));
+			VacuumCleanerOperator::Mutate(population[i], BestModelsToMutationChance, BestModelsToMutationRange, AppendRecycled(new_population));
 		}
 	}
-	
-	return new_population;
+}
+
+VacuumCleanerOperator& EvolutionTraining::AppendRecycled(std::vector<VacuumCleanerOperator>& population) {
+	if (m_Recycled.empty()) {
+		population.emplace_back();
+	} else {
+		population.push_back(std::move(m_Recycled.back()));
+		m_Recycled.pop_back();
+	}
+
+	return population.back();
+}
+
+void EvolutionTraining::Recycle(std::vector<VacuumCleanerOperator>& population) {
+	for (auto &op : population) {
+		m_Recycled.push_back(std::move(op));
+	}
+
+	population.clear();
 }
 
 void EvolutionTraining::Draw(sf::RenderTarget& rt, bool debug) {
@@ -193,7 +369,10 @@ void EvolutionTraining::DrawUI(sf::RenderTarget& rt) {
 		"Generation: " + std::to_string(m_Generation),
 		"Iterations: " + std::to_string(m_IterationsNumber),
 		"HighestGoal: " + std::to_string(m_HighestGoal),
-		"HighestFitness: " + std::to_string(m_HighestFitness)
+		"HighestFitness: " + std::to_string(m_HighestFitness),
+		"SensorsCacheHitRate: " + (m_Sensors.CacheLookups ? std::to_string(m_Sensors.CacheHitRate() * 100.f) + "%" : std::string("off")),
+		"AgentStepsPerSecond: " + std::to_string(size_t(m_StepsPerSecond)),
+		"Threads: " + std::to_string(ThreadsCount())
 	});
 
 	auto highest_goal = [](auto &l, auto &r){
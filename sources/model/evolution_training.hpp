@@ -1,10 +1,19 @@
 #pragma once
 
 #include "vacuum_cleaner_operator.hpp"
+#include "utils/nn_population.hpp"
+#include "utils/worker_pool.hpp"
+#include <memory>
 
 class EvolutionTraining {
 	std::vector<VacuumCleanerOperator> m_Population;
 	std::vector<NeuralNetworkAgent> m_BestOfEachGoal;
+
+	//dead agents and previous generations, new genomes are written into their storage
+	std::vector<VacuumCleanerOperator> m_Recycled;
+	std::vector<VacuumCleanerOperator> m_NextPopulation;
+	//crossed with random members of the new population, randomized in place
+	VacuumCleanerOperator m_RandomGenome;
 	Environment m_Env;
 
 	size_t m_Generation = 0;
@@ -14,17 +23,58 @@ class EvolutionTraining {
 	float m_HighestFitness = -2;
 
 	std::string m_BestPath;
+
+	//reused every tick
+	std::vector<VacuumCleaner*> m_Cleaners;
+	SensorsBatch m_Sensors;
+	std::vector<VacuumCleanerState> m_States;
+	std::vector<char> m_Observed;
+	//agents that should die this tick, written by workers and gathered in order
+	std::vector<char> m_Dead;
+	std::vector<int> m_Dying;
+	std::vector<std::size_t> m_BlockCacheHits;
+
+	std::unique_ptr<WorkerPool> m_Pool;
+
+	//networks of the current generation, rebuilt when genomes change
+	PopulationNetwork m_PopulationNetwork;
+	std::vector<const NeuralNetwork*> m_Networks;
+
+	size_t m_StepsCounted = 0;
+	double m_StepsTime = 0;
+	double m_StepsPerSecond = 0;
 public:
+	//agents simulated by a worker at once, sensors of a block are traced in one batch
+	static constexpr size_t AgentsBlock = 8;
+
 	EvolutionTraining(const std::string &best_path, const std::string &map_path);
 
 	void Tick(float dt);
 
+	//0 uses every hardware thread, population evolves the same for any number of threads
+	void SetThreadsCount(size_t threads);
+
+	size_t ThreadsCount()const{ return m_Pool->Size(); }
+
+	//runs ticks steps of the current population with 1, 2, 4 ... max_threads threads, population is left as it was.
+	//Items are agent steps, 0 max_threads uses every hardware thread. Blocks the caller for the whole measurement
+	//and uses the population, so nothing else should touch training until it returns
+	std::vector<Scaling> MeasureScaling(float dt, size_t max_threads = 0, size_t ticks = 200);
+
 	void NextGeneration();
 
-	std::vector<VacuumCleanerOperator> PopulationFromSorted(const std::vector<VacuumCleanerOperator> &population);
+	//appends to new_population, genomes are taken from recycled ones so that steady state does no heap allocations
+	void PopulationFromSorted(const std::vector<VacuumCleanerOperator> &population, std::vector<VacuumCleanerOperator> &new_population);
 
 	void SortPopulation();
 
+	//packs every agent compatible with the first one, others keep running their own network
+	void RebuildPopulationNetwork();
+
+	const std::vector<VacuumCleanerOperator> &Population()const{ return m_Population; }
+
+	size_t Generation()const{ return m_Generation; }
+
 	void Draw(sf::RenderTarget& rt, bool debug);
 
 	void DrawUI(sf::RenderTarget& rt);
@@ -34,4 +84,14 @@ public:
 	void SaveBest()const{ SaveBest(m_BestPath); }
 
 	static std::string MakePath(size_t goal, size_t index);
+
+private:
+	//moves every agent by one step and marks ones that should die, population itself is not changed
+	void StepAgents(float dt);
+
+	//appends recycled operator to population, its content is to be overwritten
+	VacuumCleanerOperator &AppendRecycled(std::vector<VacuumCleanerOperator> &population);
+
+	//moves every operator of population to recycled ones
+	void Recycle(std::vector<VacuumCleanerOperator> &population);
 };
@@ -0,0 +1,54 @@
+#include "lidar.hpp"
+#include "utils/math.hpp"
+#include "utils/render.hpp"
+
+Lidar::Lidar(std::size_t beams) {
+	m_LocalDirections.reserve(beams);
+
+	for (std::size_t i = 0; i < beams; i++) {
+		m_LocalDirections.push_back(Math::RotationToDirection(360.f * i / beams));
+	}
+
+	m_Distances.resize(beams);
+	m_Normals.resize(beams);
+	m_Directions.resize(beams);
+}
+
+void Lidar::Scan(const VacuumCleaner& cleaner, const Environment& env) {
+	if (!UsesSweep(env)) {
+		m_Origins.assign(BeamsCount(), cleaner.Position);
+
+		for (std::size_t i = 0; i < BeamsCount(); i++)
+			m_Directions[i] = BeamDirection(cleaner, i);
+
+		env.TraceNearestObstaclesWithNormal(m_Origins.data(), m_Directions.data(), BeamsCount(), m_Distances.data(), m_Normals.data());
+		return;
+	}
+
+	m_Polygon.Build(cleaner.Position, env.Walls);
+
+	for (std::size_t i = 0; i < BeamsCount(); i++) {
+		std::tie(m_Distances[i], m_Normals[i]) = m_Polygon.Trace(BeamDirection(cleaner, i));
+	}
+}
+
+sf::Vector2f Lidar::BeamDirection(const VacuumCleaner& cleaner, std::size_t beam)const {
+	const sf::Vector2f direction = cleaner.Direction();
+	const sf::Vector2f local = m_LocalDirections[beam];
+
+	return {
+		direction.x * local.x - direction.y * local.y,
+		direction.y * local.x + direction.x * local.y
+	};
+}
+
+void Lidar::Draw(sf::RenderTarget& rt, const VacuumCleaner &cleaner)const {
+	for (std::size_t i = 0; i < BeamsCount(); i++) {
+		//beams that hit nothing are not drawn, they would go to infinity
+		if(m_Distances[i] > 1e9f)
+			continue;
+
+		auto end = cleaner.Position + BeamDirection(cleaner, i) * m_Distances[i];
+		Render::DrawLine(rt, cleaner.Position, end, 1.f, sf::Color(255, 150, 0, 120));
+	}
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <vector>
+#include <SFML/Graphics/RenderTarget.hpp>
+#include "env/visibility.hpp"
+#include "vacuum_cleaner.hpp"
+
+//Many evenly spaced beams around the cleaner. Dense scans are sampled from one visibility polygon,
+//one O(W log W) sweep plus O(log W) per beam. Sparser ones are traced in one batch by the environment,
+//its wall table or BVH is faster than the sweep below SweepBeamsPerWall
+class Lidar {
+	std::vector<sf::Vector2f> m_LocalDirections;
+	//rays of a batched scan
+	std::vector<sf::Vector2f> m_Origins;
+	std::vector<sf::Vector2f> m_Directions;
+
+	std::vector<float> m_Distances;
+	std::vector<sf::Vector2f> m_Normals;
+
+	VisibilityPolygon m_Polygon;
+public:
+	static constexpr std::size_t DefaultBeamsCount = 64;
+
+	//sweep catches up with batched traces at about 3 beams per wall, it also assumes walls don't cross each other
+	static constexpr std::size_t SweepBeamsPerWall = 3;
+
+	Lidar(std::size_t beams = DefaultBeamsCount);
+
+	void Scan(const VacuumCleaner &cleaner, const Environment &env);
+
+	bool UsesSweep(const Environment &env)const{ return BeamsCount() >= SweepBeamsPerWall * env.Walls.size(); }
+
+	//relative to cleaner rotation, first beam looks forward
+	sf::Vector2f BeamDirection(const VacuumCleaner &cleaner, std::size_t beam)const;
+
+	std::size_t BeamsCount()const{ return m_LocalDirections.size(); }
+
+	const std::vector<float> &Distances()const{ return m_Distances; }
+
+	const std::vector<sf::Vector2f> &Normals()const{ return m_Normals; }
+
+	void Draw(sf::RenderTarget &rt, const VacuumCleaner &cleaner)const;
+};
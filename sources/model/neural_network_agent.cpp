@@ -5,32 +5,68 @@
 
 NeuralNetworkAgent::NeuralNetworkAgent(NeuralNetwork &&nn):
 	m_NN(std::move(nn))
-{}
+{
+	UpdateStaticNetwork();
+}
 
 NeuralNetworkAgent::NeuralNetworkAgent(int num_sensors):
 	m_NN(
 		{num_sensors + 2, 32, 20, 10, 2},
 		{"None", "Tanh", "None", "Tanh", "Tanh"}
 	)
-{}
+{
+	UpdateStaticNetwork();
+}
 
 sf::Vector2f NeuralNetworkAgent::Iterate(const VacuumCleaner &cleaner, const Environment & env, size_t it) {
-	if (!env.IsFullfiled()) 
+	return Iterate(cleaner, env, it, cleaner.GetSensorsState(env));
+}
+
+sf::Vector2f NeuralNetworkAgent::Iterate(const VacuumCleaner &cleaner, const Environment & env, size_t it, const VacuumCleanerSensorsState &sensors) {
+	VacuumCleanerState state;
+
+	if(!Observe(cleaner, env, it, sensors, state))
 		return {};
 
+	if (m_QuantizedNN) {
+		NeuralNetworkAgent::StateToMatrix(state, m_Input);
+		const float *output = m_QuantizedNN->Do(m_Input.Data());
+
+		return Act(cleaner, env, state, {output[0], output[1]});
+	}
+
+	if (const AgentNetwork *network = UnrolledNetwork()) {
+		std::array<float, AgentNetwork::Inputs> input;
+		std::array<float, AgentNetwork::Outputs> output;
+
+		NeuralNetworkAgent::StateToInput(state, input.data());
+		network->Do(input.data(), output.data());
+
+		return Act(cleaner, env, state, {output[0], output[1]});
+	}
+
+	NeuralNetworkAgent::StateToMatrix(state, m_Input);
+
+	m_NN.Do(m_Input, m_Output);
+
+	return Act(cleaner, env, state, NeuralNetworkAgent::MoveFromMatrix(m_Output));
+}
+
+bool NeuralNetworkAgent::Observe(const VacuumCleaner &cleaner, const Environment & env, size_t it, const VacuumCleanerSensorsState &sensors, VacuumCleanerState &state) {
+	if (!env.IsFullfiled()) 
+		return false;
+
 	if(m_CurrentGoal >= env.Path.size())
-		return {};
+		return false;
 
 	m_Iteration = it;
 
-	VacuumCleanerState state = cleaner.GetState(m_CurrentGoal, env);
+	state = cleaner.GetState(m_CurrentGoal, env, sensors);
 
-	auto move = NeuralNetworkAgent::MoveFromMatrix(
-		m_NN.Do(
-			NeuralNetworkAgent::StateToMatrix(state)
-		)
-	);
+	return true;
+}
 
+sf::Vector2f NeuralNetworkAgent::Act(const VacuumCleaner &cleaner, const Environment & env, const VacuumCleanerState &state, sf::Vector2f move) {
 	float forward  = move.x;
 	float rotation = move.y;
 
@@ -108,26 +144,108 @@ void NeuralNetworkAgent::LoadFromFile(const std::string& filename) {
 		return;
 
 	m_NN = std::move(nn.value());
+
+	UpdateStaticNetwork();
+}
+
+bool NeuralNetworkAgent::LoadQuantizedFromFile(const std::string& filename) {
+	std::fstream file(filename, std::ios::binary | std::ios::in);
+
+	auto network = Serializer<QuantizedNetwork>::FromStream(file);
+
+	if(!network.has_value())
+		return false;
+
+	return SetQuantized(std::make_shared<const QuantizedNetwork>(std::move(network.value())));
+}
+
+bool NeuralNetworkAgent::SetQuantized(std::shared_ptr<const QuantizedNetwork> network) {
+	const auto &topology = m_NN.Topology();
+
+	if(network && (topology.size() < 2 || network->Inputs() != std::size_t(topology.front()) || network->Outputs() != std::size_t(topology.back())))
+		return false;
+
+	m_QuantizedNN = std::move(network);
+
+	return true;
+}
+
+void NeuralNetworkAgent::UpdateStaticNetwork() {
+	m_StaticNN.IsOutdated = true;
+	m_QuantizedNN = nullptr;
+}
+
+const AgentNetwork *NeuralNetworkAgent::UnrolledNetwork() {
+	if (m_StaticNN.IsOutdated) {
+		m_StaticNN.IsOutdated = false;
+		m_StaticNN.IsAvailable = AgentNetwork::IsCompatible(m_NN);
+
+		if (m_StaticNN.IsAvailable) {
+			if(!m_StaticNN.Network)
+				m_StaticNN.Network = std::make_unique<AgentNetwork>();
+			*m_StaticNN.Network = AgentNetwork::FromNetwork(m_NN).value();
+		}
+	}
+
+	return m_StaticNN.IsAvailable ? m_StaticNN.Network.get() : nullptr;
+}
+
+void NeuralNetworkAgent::Restart() {
+	m_CurrentGoal = 0;
+	m_HasEscaped = false;
+	m_Iteration = 0;
+	m_TotalDistanceTraveled = 0.f;
+
+	m_InitialDistanceToGoal = 0.f;
+	m_MaxDistanceToGoal = 0.f;
+	m_MinDistanceToGoal = 0.f;
+	m_CurrentDistanceToGoal = 0.f;
+
+	UpdateStaticNetwork();
+}
+
+void NeuralNetworkAgent::Randomize() {
+	m_NN.Randomize();
+	Restart();
 }
 
 NeuralNetworkAgent NeuralNetworkAgent::Crossover(const NeuralNetworkAgent& first, const NeuralNetworkAgent &second) {
 	return {NeuralNetwork::Crossover(first.m_NN, second.m_NN)};
 }
 
+void NeuralNetworkAgent::Crossover(const NeuralNetworkAgent& first, const NeuralNetworkAgent &second, NeuralNetworkAgent &child) {
+	NeuralNetwork::Crossover(first.m_NN, second.m_NN, child.m_NN);
+	child.Restart();
+}
+
 NeuralNetworkAgent NeuralNetworkAgent::Mutate(const NeuralNetworkAgent& agent, float chance, float range) {
 	return {NeuralNetwork::MutateNetwork(agent.m_NN, chance, range)};
 }
 
+void NeuralNetworkAgent::Mutate(const NeuralNetworkAgent& agent, float chance, float range, NeuralNetworkAgent &mutated) {
+	NeuralNetwork::MutateNetwork(agent.m_NN, chance, range, mutated.m_NN);
+	mutated.Restart();
+}
+
 Matrix<float> NeuralNetworkAgent::StateToMatrix(const VacuumCleanerState& state) {
-	Matrix<float> input(1, state.SensorsData.size() + 2);
+	Matrix<float> input;
+	StateToMatrix(state, input);
+	return input;
+}
+
+void NeuralNetworkAgent::StateToMatrix(const VacuumCleanerState& state, Matrix<float>& input) {
+	if(input.N() != 1 || input.M() != InputsCount(state))
+		input = Matrix<float>(1, InputsCount(state));
+
+	StateToInput(state, input.Data());
+}
 
+void NeuralNetworkAgent::StateToInput(const VacuumCleanerState& state, float *input) {
 	for (int i = 0; i < state.SensorsData.size(); i++)
-		input[0][i] = state.SensorsData[i];
+		input[i] = state.SensorsData[i];
 
-	input[0][state.SensorsData.size()    ] = state.DistanceToGoal;
-	input[0][state.SensorsData.size() + 1] = state.RotationToGoal;
-	
-	return input;
+	input[state.SensorsData.size()    ] = state.DistanceToGoal;
+	input[state.SensorsData.size() + 1] = state.RotationToGoal;
 }
 
 sf::Vector2f NeuralNetworkAgent::MoveFromMatrix(const Matrix<float>& out) {
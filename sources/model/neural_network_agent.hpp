@@ -1,12 +1,37 @@
 #pragma once
 
 #include "utils/nn.hpp"
+#include "utils/static_nn.hpp"
+#include "utils/nn_quantized.hpp"
 #include <vector>
+#include <memory>
 #include "vacuum_cleaner.hpp"
 #include "env/environment.hpp"
 
+//topology every agent is created with
+using AgentNetwork = StaticNetwork<CleanerSensorsCount + 2, 32, 20, 10, 2>;
+
 class NeuralNetworkAgent {
+	//unrolled copy of the network for agents running on their own, built on their first Iterate after network changes.
+	//Agents of a packed population never build one, copies start outdated so copying an agent doesn't copy it
+	struct StaticNetworkCache {
+		std::unique_ptr<AgentNetwork> Network;
+		bool IsOutdated = true;
+		//false when network has other topology
+		bool IsAvailable = false;
+
+		StaticNetworkCache() = default;
+		StaticNetworkCache(StaticNetworkCache &&) = default;
+		StaticNetworkCache(const StaticNetworkCache &) {}
+
+		StaticNetworkCache &operator=(StaticNetworkCache &&) = default;
+		StaticNetworkCache &operator=(const StaticNetworkCache &) { IsOutdated = true; return *this; }
+	};
+
 	NeuralNetwork m_NN;
+	StaticNetworkCache m_StaticNN;
+	//int8 model of m_NN for deployment, runs instead of it until network changes. Read only, so copies share it
+	std::shared_ptr<const QuantizedNetwork> m_QuantizedNN;
 	int m_CurrentGoal = 0;
 	bool m_HasEscaped = false;
 	size_t m_Iteration = 0;
@@ -17,6 +42,10 @@ class NeuralNetworkAgent {
 	float m_MinDistanceToGoal = 0.f;
 	float m_CurrentDistanceToGoal = 0.f;
 
+	//network input and output are written in place every iteration
+	Matrix<float> m_Input;
+	Matrix<float> m_Output;
+
 	friend struct Serializer<NeuralNetworkAgent>;
 public:
 
@@ -36,6 +65,18 @@ public:
 
 	sf::Vector2f Iterate(const VacuumCleaner &cleaner, const Environment & env, size_t it);
 
+	//sensors are already traced for this cleaner, see VacuumCleaner::GetSensorsStates
+	sf::Vector2f Iterate(const VacuumCleaner &cleaner, const Environment & env, size_t it, const VacuumCleanerSensorsState &sensors);
+
+	//Iterate split around the network, so it can be run for many agents at once, see PopulationNetwork
+	//false when agent has nothing to do and should stay still
+	bool Observe(const VacuumCleaner &cleaner, const Environment & env, size_t it, const VacuumCleanerSensorsState &sensors, VacuumCleanerState &state);
+
+	//move is the network output for observed state
+	sf::Vector2f Act(const VacuumCleaner &cleaner, const Environment & env, const VacuumCleanerState &state, sf::Vector2f move);
+
+	const NeuralNetwork &Network()const{ return m_NN; }
+
 	size_t CurrentGoal()const;
 
 	bool HasNotTraveled()const;
@@ -54,15 +95,50 @@ public:
 
 	void LoadFromFile(const std::string& filename);
 
+	//false when file is not a quantized model of this agent topology, agent keeps running the float network then
+	bool LoadQuantizedFromFile(const std::string& filename);
+
+	//nullptr goes back to the float network
+	bool SetQuantized(std::shared_ptr<const QuantizedNetwork> network);
+
+	bool IsQuantized()const{ return m_QuantizedNN != nullptr; }
+
+	//new weights for the same topology, progress starts over
+	void Randomize();
+
 	static NeuralNetworkAgent Crossover(const NeuralNetworkAgent& first, const NeuralNetworkAgent &second);
 
+	//child ends up like a new agent, its network storage is reused
+	static void Crossover(const NeuralNetworkAgent& first, const NeuralNetworkAgent &second, NeuralNetworkAgent &child);
+
 	static NeuralNetworkAgent Mutate(const NeuralNetworkAgent& agent, float chance, float range);
 
+	//mutated ends up like a new agent, its network storage is reused, mutated may be the agent itself
+	static void Mutate(const NeuralNetworkAgent& agent, float chance, float range, NeuralNetworkAgent &mutated);
+
 	static Matrix<float> StateToMatrix(const VacuumCleanerState &state);
 
+	//reuses input storage when it already has the right shape
+	static void StateToMatrix(const VacuumCleanerState &state, Matrix<float> &input);
+
+	//writes InputsCount(state) elements
+	static void StateToInput(const VacuumCleanerState &state, float *input);
+
+	static std::size_t InputsCount(const VacuumCleanerState &state){ return state.SensorsData.size() + 2; }
+
 	static sf::Vector2f MoveFromMatrix(const Matrix<float> &out);
 
 	static Matrix<float> MoveToMatrix(sf::Vector2f move);
+
+private:
+	//network changed, unrolled copy is rebuilt when needed and quantized one is dropped
+	void UpdateStaticNetwork();
+
+	//nullptr when network can't be unrolled, storage of the previous copy is reused
+	const AgentNetwork *UnrolledNetwork();
+
+	//progress of a new agent, network is kept
+	void Restart();
 };
 
 
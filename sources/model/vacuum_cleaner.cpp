@@ -3,17 +3,27 @@
 #include "utils/render.hpp"
 #include "config.hpp"
 
-VacuumCleaner::VacuumCleaner() {
-	Sensors.push_back({0});
+const std::array<Sensor, CleanerSensorsCount> VacuumCleaner::Sensors = {
+	Sensor{0},
 
-	Sensors.push_back({30});
-	Sensors.push_back({-30});
+	Sensor{30},
+	Sensor{-30},
 
-	Sensors.push_back({60});
-	Sensors.push_back({-60});
+	Sensor{60},
+	Sensor{-60},
 
-	Sensors.push_back({180});
-}
+	Sensor{180}
+};
+
+const std::array<sf::Vector2f, CleanerSensorsCount> VacuumCleaner::SensorsDirections = []() {
+	std::array<sf::Vector2f, CleanerSensorsCount> directions;
+
+	for (std::size_t i = 0; i < directions.size(); i++) {
+		directions[i] = Math::RotationToDirection(Sensors[i].Rotation);
+	}
+
+	return directions;
+}();
 
 void VacuumCleaner::Move(float forward, float rotate) {
 	Rotation += rotate;
@@ -24,8 +34,8 @@ void VacuumCleaner::Draw(sf::RenderTarget& rt, sf::Color color)const {
 
 	Render::DrawCircle(rt, Position, CleanerRadius, color, 3, sf::Color::White);
 	
-	for (auto sensor : Sensors) {
-		auto sensor_direction = Math::RotationToDirection(sensor.Rotation + Rotation);
+	for (std::size_t i = 0; i < Sensors.size(); i++) {
+		auto sensor_direction = SensorDirection(i);
 		auto start = Position + sensor_direction * CleanerRadius;
 		auto end = start + sensor_direction * CleanerRayLength;
 		Render::DrawLine(rt, start, end, 3, sf::Color::Red);
@@ -39,34 +49,111 @@ sf::Vector2f VacuumCleaner::Direction()const {
 	return Math::RotationToDirection(Rotation);
 }
 
+sf::Vector2f VacuumCleaner::SensorDirection(std::size_t sensor)const {
+	return SensorDirection(sensor, Direction());
+}
+
+sf::Vector2f VacuumCleaner::SensorDirection(std::size_t sensor, sf::Vector2f cleaner_direction) {
+	const sf::Vector2f local = SensorsDirections[sensor];
+
+	return {
+		cleaner_direction.x * local.x - cleaner_direction.y * local.y,
+		cleaner_direction.y * local.x + cleaner_direction.x * local.y
+	};
+}
+
 VacuumCleanerSensorsState VacuumCleaner::GetSensorsState(const Environment& env)const {
 	VacuumCleanerSensorsState state;
+	const auto cleaner_direction = Direction();
 
-	for (auto sensor: Sensors) {
-		auto direction = Math::RotationToDirection(Rotation + sensor.Rotation);
+	for (std::size_t i = 0; i < Sensors.size(); i++) {
+		auto direction = SensorDirection(i, cleaner_direction);
 #if 0
 		auto start = Position + CleanerRadius * direction; 
 #else
 		auto start = Position;
 #endif
-		auto[distance, normal] = Wall::TraceNearestObstacleWithNormal(start, direction, env.Walls);
-		state.SensorsData.push_back(distance);
-		state.SensorsIntersectionNormal.push_back(normal);
+		std::tie(state.SensorsData[i], state.SensorsIntersectionNormal[i]) = env.TraceNearestObstacleWithNormal(start, direction);
 	}
 
 	return state;
 }
 
 
+void SensorsBatch::Resize(std::size_t cleaners, std::size_t sensors) {
+	CleanersCount = cleaners;
+	SensorsCount = sensors;
+
+	Distances.resize(cleaners * sensors);
+	Normals.resize(cleaners * sensors);
+	Origins.resize(cleaners * sensors);
+	Directions.resize(cleaners * sensors);
+	HitWalls.resize(cleaners * sensors);
+}
+
+VacuumCleanerSensorsState SensorsBatch::State(std::size_t cleaner)const {
+	auto first = cleaner * SensorsCount;
+
+	VacuumCleanerSensorsState state;
+	std::copy_n(Distances.begin() + first, SensorsCount, state.SensorsData.begin());
+	std::copy_n(Normals.begin() + first, SensorsCount, state.SensorsIntersectionNormal.begin());
+	return state;
+}
+
+void VacuumCleaner::GetSensorsStates(const std::vector<VacuumCleaner*> &cleaners, const Environment &env, SensorsBatch &batch) {
+	batch.Resize(cleaners.size(), Sensors.size());
+
+	const std::size_t hits = TraceSensors(cleaners, env, batch, 0, cleaners.size());
+
+	if (env.CanUseSensorsCache()) {
+		batch.CacheHits += hits;
+		batch.CacheLookups += batch.Origins.size();
+	}
+}
+
+std::size_t VacuumCleaner::TraceSensors(const std::vector<VacuumCleaner*> &cleaners, const Environment &env, SensorsBatch &batch, std::size_t begin, std::size_t end) {
+	const std::size_t sensors = Sensors.size();
+	const std::size_t first = begin * sensors;
+	const std::size_t count = (end - begin) * sensors;
+
+	assert(batch.CleanersCount == cleaners.size() && batch.SensorsCount == sensors && end <= cleaners.size());
+
+	for (std::size_t i = begin; i < end; i++) {
+		const VacuumCleaner &cleaner = *cleaners[i];
+		const auto cleaner_direction = cleaner.Direction();
+
+		for (std::size_t j = 0; j < sensors; j++) {
+			batch.Origins[i * sensors + j] = cleaner.Position;
+			batch.Directions[i * sensors + j] = SensorDirection(j, cleaner_direction);
+			batch.HitWalls[i * sensors + j] = cleaner.SensorsHitWalls[j];
+		}
+	}
+
+	if (!env.CanUseSensorsCache()) {
+		env.TraceNearestObstaclesWithNormal(batch.Origins.data() + first, batch.Directions.data() + first, count, batch.Distances.data() + first, batch.Normals.data() + first);
+		return 0;
+	}
+
+	const std::size_t hits = env.TraceNearestObstaclesWithNormal(batch.Origins.data() + first, batch.Directions.data() + first, count, batch.Distances.data() + first, batch.Normals.data() + first, batch.HitWalls.data() + first);
+
+	for (std::size_t i = begin; i < end; i++) {
+		std::copy_n(batch.HitWalls.begin() + i * sensors, sensors, cleaners[i]->SensorsHitWalls.begin());
+	}
+
+	return hits;
+}
+
 VacuumCleanerState VacuumCleaner::GetState(std::size_t current_goal, const Environment& env)const {
-	VacuumCleanerState state = GetSensorsState(env);
+	return GetState(current_goal, env, GetSensorsState(env));
+}
+
+VacuumCleanerState VacuumCleaner::GetState(std::size_t current_goal, const Environment& env, const VacuumCleanerSensorsState &sensors)const {
+	VacuumCleanerState state = sensors;
 	sf::Vector2f goal(env.Path[current_goal]);
 
 	auto direction = goal - Position;
 	
 	float difference_with_goal = acos(direction.normalized().dot(Direction().normalized())) / 3.14 * 180;
-	
-	state = GetSensorsState(env);
 
 	state.RotationToGoal = difference_with_goal;
 	state.DistanceToGoal = direction.length();
@@ -84,7 +171,7 @@ void VacuumCleaner::DrawIntersections(sf::RenderTarget& rt, const Environment &e
 
 	for (int i = 0; i < cleaner.Sensors.size(); i++) {
 
-		auto direction = Math::RotationToDirection(cleaner.Rotation + cleaner.Sensors[i].Rotation);
+		auto direction = cleaner.SensorDirection(i);
 		auto start = cleaner.Position; 
 
 		float distance = state.SensorsData[i];
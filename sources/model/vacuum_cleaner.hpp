@@ -3,24 +3,28 @@
 #include <SFML/Graphics.hpp>
 #include <optional>
 #include <vector>
+#include <array>
+#include <algorithm>
 #include <fstream>
 #include "bsl/serialization_std.hpp"
 #include "env/environment.hpp"
+#include "config.hpp"
 
 struct Sensor {
 	float Rotation = 0.f;
 };
 
+//fixed capacity, filled every tick for every agent without touching the heap
 struct VacuumCleanerSensorsState {
-	std::vector<float> SensorsData;
-	std::vector<sf::Vector2f> SensorsIntersectionNormal;
+	std::array<float, CleanerSensorsCount> SensorsData{};
+	std::array<sf::Vector2f, CleanerSensorsCount> SensorsIntersectionNormal{};
 
 	VacuumCleanerSensorsState() = default;
 
-	VacuumCleanerSensorsState(const std::vector<float>& sensorsData, const std::vector<sf::Vector2f>& sensorsIntersectionNormal): 
-		SensorsData(sensorsData), 
-		SensorsIntersectionNormal(sensorsIntersectionNormal) 
-	{}
+	VacuumCleanerSensorsState(const std::vector<float>& sensorsData, const std::vector<sf::Vector2f>& sensorsIntersectionNormal) {
+		std::copy_n(sensorsData.begin(), std::min(sensorsData.size(), SensorsData.size()), SensorsData.begin());
+		std::copy_n(sensorsIntersectionNormal.begin(), std::min(sensorsIntersectionNormal.size(), SensorsIntersectionNormal.size()), SensorsIntersectionNormal.begin());
+	}
 
 	bool IsCollided(std::size_t index)const {
 		if(index >= SensorsData.size())
@@ -42,17 +46,18 @@ struct VacuumCleanerState: public VacuumCleanerSensorsState{
 		RotationToGoal(rotationToGoal)
 	{}
 
-	VacuumCleanerState(const VacuumCleanerSensorsState& state) {
-		SensorsData = state.SensorsData;
-		SensorsIntersectionNormal = state.SensorsIntersectionNormal;
-	}
+	VacuumCleanerState(const VacuumCleanerSensorsState& state):
+		VacuumCleanerSensorsState(state)
+	{}
 };
 
+//stored as vectors to stay compatible with datasets saved before fixed size state,
+//states of a different sensors count are rejected
 template<>
 struct Serializer<VacuumCleanerState>{
 	static void ToStream(const VacuumCleanerState& state, std::ostream& stream) {
-		Serializer<std::vector<float>>::ToStream(state.SensorsData, stream);
-		Serializer<std::vector<sf::Vector2f>>::ToStream(state.SensorsIntersectionNormal, stream);
+		Serializer<std::vector<float>>::ToStream({state.SensorsData.begin(), state.SensorsData.end()}, stream);
+		Serializer<std::vector<sf::Vector2f>>::ToStream({state.SensorsIntersectionNormal.begin(), state.SensorsIntersectionNormal.end()}, stream);
 		Serializer<float>::ToStream(state.DistanceToGoal, stream);
 		Serializer<float>::ToStream(state.RotationToGoal, stream);
 	}
@@ -65,18 +70,59 @@ struct Serializer<VacuumCleanerState>{
 
 		if(!d.has_value() || !r.has_value() || !s.has_value() || !n.has_value())
 			return std::nullopt;
+
+		if(s->size() != CleanerSensorsCount || n->size() != CleanerSensorsCount)
+			return std::nullopt;
 		
-		return VacuumCleanerState(std::move(s.value()), std::move(n.value()), d.value(), r.value());
+		return VacuumCleanerState(s.value(), n.value(), d.value(), r.value());
 	}
 };
 
+//sensors of many cleaners traced at once, row per cleaner
+struct SensorsBatch {
+	std::size_t CleanersCount = 0;
+	std::size_t SensorsCount = 0;
+
+	//CleanersCount x SensorsCount, row major
+	std::vector<float> Distances;
+	std::vector<sf::Vector2f> Normals;
+
+	//ray of each sensor, same layout, kept to not reallocate every tick
+	std::vector<sf::Vector2f> Origins;
+	std::vector<sf::Vector2f> Directions;
+	std::vector<std::int32_t> HitWalls;
+
+	//accumulated over all batches, for telemetry
+	std::size_t CacheLookups = 0;
+	std::size_t CacheHits = 0;
+
+	float CacheHitRate()const{ return CacheLookups ? CacheHits / float(CacheLookups) : 0.f; }
+
+	void Resize(std::size_t cleaners, std::size_t sensors);
+
+	const float *Row(std::size_t cleaner)const{ return Distances.data() + cleaner * SensorsCount; }
+
+	VacuumCleanerSensorsState State(std::size_t cleaner)const;
+};
+
+inline std::array<std::int32_t, CleanerSensorsCount> NoSensorsHitWalls() {
+	std::array<std::int32_t, CleanerSensorsCount> walls;
+	walls.fill(-1);
+	return walls;
+}
+
 struct VacuumCleaner {
 	sf::Vector2f Position{0.f, 0.f};
 	float Rotation = 0.f;
 
-	std::vector<Sensor> Sensors;
+	static const std::array<Sensor, CleanerSensorsCount> Sensors;
+	//Sensors rotations as unit vectors relative to Forward
+	static const std::array<sf::Vector2f, CleanerSensorsCount> SensorsDirections;
+
+	//last wall hit by each sensor, trace hint only, results are the same without it. Updated by TraceSensors
+	std::array<std::int32_t, CleanerSensorsCount> SensorsHitWalls = NoSensorsHitWalls();
 
-	VacuumCleaner();
+	VacuumCleaner() = default;
 
 	void Move(float forward, float rotate);
 
@@ -84,9 +130,23 @@ struct VacuumCleaner {
 
 	sf::Vector2f Direction()const;
 
+	sf::Vector2f SensorDirection(std::size_t sensor)const;
+
+	//rotates precomputed sensor direction by direction of the cleaner, no trigonometry involved
+	static sf::Vector2f SensorDirection(std::size_t sensor, sf::Vector2f cleaner_direction);
+
+	//traces without hints, SensorsHitWalls are left as they are
 	VacuumCleanerSensorsState GetSensorsState(const Environment &env)const;
 
 	VacuumCleanerState GetState(std::size_t current_goal, const Environment &env)const;
 
+	VacuumCleanerState GetState(std::size_t current_goal, const Environment &env, const VacuumCleanerSensorsState &sensors)const;
+
+	static void GetSensorsStates(const std::vector<VacuumCleaner*> &cleaners, const Environment &env, SensorsBatch &batch);
+
+	//traces rows [begin, end) of a batch already resized for cleaners and returns sensors cache hits, cache counters are
+	//left to the caller. Touches only these rows and SensorsHitWalls of these cleaners, so disjoint ranges can be traced from different threads
+	static std::size_t TraceSensors(const std::vector<VacuumCleaner*> &cleaners, const Environment &env, SensorsBatch &batch, std::size_t begin, std::size_t end);
+
 	void DrawIntersections(sf::RenderTarget& rt, const Environment &env);
 };
\ No newline at end of file
@@ -11,10 +11,38 @@ VacuumCleanerOperator::VacuumCleanerOperator(const NeuralNetworkAgent &agent):
 	m_Agent(agent)
 {}
 
+VacuumCleanerOperator& VacuumCleanerOperator::operator=(const NeuralNetworkAgent& agent) {
+	m_Agent = agent;
+	Restart();
+
+	return *this;
+}
+
+void VacuumCleanerOperator::Restart() {
+	m_Cleaner = VacuumCleaner();
+	m_StandStill = 0;
+	m_NumberFailure = 0;
+	m_Slot = NoSlot;
+}
+
 void VacuumCleanerOperator::Iterate(const Environment &env, float dt, size_t it_num) {
+	Apply(m_Agent.Iterate(m_Cleaner, env, it_num), dt);
+}
+
+void VacuumCleanerOperator::Iterate(const Environment &env, float dt, size_t it_num, const VacuumCleanerSensorsState &sensors) {
+	Apply(m_Agent.Iterate(m_Cleaner, env, it_num, sensors), dt);
+}
 
+bool VacuumCleanerOperator::Observe(const Environment &env, size_t it_num, const VacuumCleanerSensorsState &sensors, VacuumCleanerState &state) {
+	return m_Agent.Observe(m_Cleaner, env, it_num, sensors, state);
+}
+
+void VacuumCleanerOperator::Act(const Environment &env, float dt, const VacuumCleanerState &state, sf::Vector2f move) {
+	Apply(m_Agent.Act(m_Cleaner, env, state, move), dt);
+}
+
+void VacuumCleanerOperator::Apply(sf::Vector2f it, float dt) {
 	bool UseDeltaTime = false;
-	auto it = m_Agent.Iterate(m_Cleaner, env, it_num);
 	auto [forward, rotation] = it.cwiseMul(sf::Vector2f(40, 40)) * (UseDeltaTime ? dt : 0.016f);
 
 	if(std::abs(forward) < Eps && std::abs(rotation) < Eps)
@@ -71,18 +99,24 @@ NeuralNetworkAgent& VacuumCleanerOperator::Agent() {
 }
 
 bool VacuumCleanerOperator::HasCrashed(const Environment &env)const {
-	for (const auto &wall : env.Walls) {
-		if(Math::LineCircleIntersection(sf::Vector2f(wall.Start), sf::Vector2f(wall.End), m_Cleaner.Position, CleanerRadius))
-			return true;
-	}
-	return false;
+	return env.IsCrashed(m_Cleaner.Position);
 }
 
 VacuumCleanerOperator VacuumCleanerOperator::Crossover(const VacuumCleanerOperator& first, const VacuumCleanerOperator &second) {
 	return {NeuralNetworkAgent::Crossover(first.m_Agent, second.m_Agent)};
 }
 
+void VacuumCleanerOperator::Crossover(const VacuumCleanerOperator& first, const VacuumCleanerOperator &second, VacuumCleanerOperator &child) {
+	NeuralNetworkAgent::Crossover(first.m_Agent, second.m_Agent, child.m_Agent);
+	child.Restart();
+}
+
 VacuumCleanerOperator VacuumCleanerOperator::Mutate(const VacuumCleanerOperator& agent, float chance, float range) {
 	return {NeuralNetworkAgent::Mutate(agent.m_Agent, chance, range)};
 }
 
+void VacuumCleanerOperator::Mutate(const VacuumCleanerOperator& agent, float chance, float range, VacuumCleanerOperator &mutated) {
+	NeuralNetworkAgent::Mutate(agent.m_Agent, chance, range, mutated.m_Agent);
+	mutated.Restart();
+}
+
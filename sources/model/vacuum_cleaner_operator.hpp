@@ -9,7 +9,10 @@ class VacuumCleanerOperator {
 
 	size_t m_StandStill = 0;
 	size_t m_NumberFailure = 0;
+
+	size_t m_Slot = NoSlot;
 public:
+	static constexpr size_t NoSlot = -1;
 
 	VacuumCleanerOperator() = default;
 
@@ -22,9 +25,22 @@ public:
 	VacuumCleanerOperator(NeuralNetworkAgent &&agent);
 
 	VacuumCleanerOperator(const NeuralNetworkAgent &agent);
+
+	//same as assigning a new operator made of agent, storage of the network is reused
+	VacuumCleanerOperator &operator=(const NeuralNetworkAgent &agent);
 	
 	void Iterate(const Environment &env, float dt, size_t it_num);
 
+	void Iterate(const Environment &env, float dt, size_t it_num, const VacuumCleanerSensorsState &sensors);
+
+	//Iterate with network evaluated outside, see NeuralNetworkAgent::Observe
+	bool Observe(const Environment &env, size_t it_num, const VacuumCleanerSensorsState &sensors, VacuumCleanerState &state);
+
+	void Act(const Environment &env, float dt, const VacuumCleanerState &state, sf::Vector2f move);
+
+	//for agents that had nothing to observe
+	void Idle(float dt){ Apply({}, dt); }
+
 	void Draw(sf::RenderTarget& rt)const;
 
 	void DrawFitness(sf::RenderTarget& rt, const Environment &env)const;
@@ -41,9 +57,32 @@ public:
 
 	NeuralNetworkAgent& Agent();
 
+	const NeuralNetworkAgent& Agent()const{ return m_Agent; }
+
+	VacuumCleaner &Cleaner(){ return m_Cleaner; }
+
+	const VacuumCleaner &Cleaner()const{ return m_Cleaner; }
+
+	//index of agent network in the packed population, NoSlot when it runs on its own
+	size_t Slot()const{ return m_Slot; }
+
+	void SetSlot(size_t slot){ m_Slot = slot; }
+
 	bool HasCrashed(const Environment &env)const;
 
 	static VacuumCleanerOperator Crossover(const VacuumCleanerOperator& first, const VacuumCleanerOperator &second);
 
+	//child ends up like a new operator, see NeuralNetworkAgent::Crossover
+	static void Crossover(const VacuumCleanerOperator& first, const VacuumCleanerOperator &second, VacuumCleanerOperator &child);
+
 	static VacuumCleanerOperator Mutate(const VacuumCleanerOperator& agent, float chance, float range);
+
+	//mutated ends up like a new operator, mutated may be the agent itself
+	static void Mutate(const VacuumCleanerOperator& agent, float chance, float range, VacuumCleanerOperator &mutated);
+
+private:
+	void Apply(sf::Vector2f it, float dt);
+
+	//cleaner and counters of a new operator
+	void Restart();
 };
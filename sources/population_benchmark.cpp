@@ -0,0 +1,122 @@
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <filesystem>
+#include <bsl/log.hpp>
+#include "model/evolution_training.hpp"
+#include "benchmark_room.hpp"
+#include "utils/random.hpp"
+
+static std::size_t s_Failures = 0;
+
+static void Expect(const std::string &name, bool condition) {
+	Println("%: %", name, condition ? "ok" : "FAILED");
+
+	s_Failures += !condition;
+}
+
+//every index runs exactly once whatever workers steal, items of uneven cost make them steal
+static void BenchmarkWorkStealing() {
+	bool once = true;
+
+	for (std::size_t threads : {1, 2, 3, 4, 8}) {
+		WorkerPool pool(threads);
+
+		for (std::size_t count : {0, 1, 2, 17, 1000, 4097}) {
+			for (std::size_t grain : {1, 3, 64}) {
+				std::vector<std::atomic<int>> runs(count);
+
+				pool.ParallelFor(count, grain, [&](std::size_t index, std::size_t worker) {
+					if(index % 97 == 0)
+						std::this_thread::sleep_for(std::chrono::microseconds(20));
+					runs[index]++;
+				});
+
+				for(const auto &run : runs)
+					once &= run == 1;
+			}
+		}
+	}
+
+	Expect("WorkerPool::ParallelFor with stealing runs every index once", once);
+}
+
+static void BenchmarkPopulationNetwork() {
+	std::vector<NeuralNetwork> networks;
+	for(int i = 0; i < 500; i++)
+		networks.emplace_back(std::vector<int>{CleanerSensorsCount + 2, 32, 20, 10, 2}, std::vector<std::string>{"None", "Tanh", "None", "Tanh", "Tanh"});
+
+	std::vector<const NeuralNetwork*> pointers;
+	for(const auto &network : networks)
+		pointers.push_back(&network);
+
+	PopulationNetwork population(pointers);
+	for (std::size_t slot = 0; slot < networks.size(); slot++) {
+		const Matrix<float> input = Matrix<float>::Random(1, CleanerSensorsCount + 2, -1, 1);
+		population.SetInput(slot, input.Data());
+	}
+
+	population.Do();
+	std::vector<float> serial;
+	for(std::size_t slot = 0; slot < networks.size(); slot++)
+		serial.push_back(population.Output(slot, 0));
+
+	WorkerPool pool(4);
+	population.Do(pool);
+
+	bool exact = true;
+	for(std::size_t slot = 0; slot < networks.size(); slot++)
+		exact &= serial[slot] == population.Output(slot, 0);
+
+	Expect("PopulationNetwork::Do on 4 threads is bit exact", exact);
+}
+
+//agents positions and fitness after ticks, training starts from the same seed every time
+static std::vector<float> TrainingFingerprint(const std::string &best_path, const std::string &map_path, std::size_t threads, std::size_t ticks) {
+	std::filesystem::remove(best_path);
+	RandomGenerator::SetSeed(RandomGenerator::DefaultSeed);
+
+	EvolutionTraining training(best_path, map_path);
+	training.SetThreadsCount(threads);
+
+	for(std::size_t i = 0; i < ticks; i++)
+		training.Tick(1.f / 60);
+
+	std::vector<float> fingerprint{float(training.Generation()), float(training.Population().size())};
+	for (const auto &agent : training.Population()) {
+		fingerprint.push_back(agent.Cleaner().Position.x);
+		fingerprint.push_back(agent.Cleaner().Position.y);
+		fingerprint.push_back(agent.CurrentGoal());
+	}
+
+	return fingerprint;
+}
+
+static void BenchmarkTraining() {
+	const auto directory = std::filesystem::temp_directory_path();
+	const std::string map_path = (directory / "population_benchmark.map").string();
+	const std::string best_path = (directory / "population_benchmark.mod").string();
+
+	Environment env;
+	MakeBenchmarkRoom(env);
+	env.SaveToFile(map_path);
+
+	//long enough for a couple of generations
+	const std::size_t ticks = 2500;
+	const std::vector<float> serial = TrainingFingerprint(best_path, map_path, 1, ticks);
+
+	for (std::size_t threads : {2, 4, 8}) {
+		Expect("Training on " + std::to_string(threads) + " threads matches single thread", TrainingFingerprint(best_path, map_path, threads, ticks) == serial);
+	}
+
+	std::filesystem::remove(map_path);
+	std::filesystem::remove(best_path);
+}
+
+int main() {
+	BenchmarkWorkStealing();
+	BenchmarkPopulationNetwork();
+	BenchmarkTraining();
+
+	return s_Failures ? 1 : 0;
+}
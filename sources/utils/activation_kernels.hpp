@@ -0,0 +1,157 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <algorithm>
+#include <iterator>
+#include "matrix_kernels.hpp"
+
+#if MATRIX_KERNELS_SSE
+	#include <xmmintrin.h>
+#endif
+
+enum class Activation {
+	//anything without a dedicated kernel, called through the function pointer
+	Custom,
+	None,
+	Tanh,
+	Sigmoid
+};
+
+//Bias subtraction fused with activation, dispatched once per layer instead of an indirect call per element.
+//Fast variants use rational approximation of tanh, sigmoid(x) = 0.5 + 0.5 * tanh(x / 2).
+//Max absolute error against double precision on [-20, 20]: tanh 3.9e-7, sigmoid 1.9e-7 (libm tanhf is 1.1e-7)
+namespace ActivationKernels {
+	//beyond it float tanh is exactly +-1
+	constexpr float TanhClamp = 7.90531110763549805f;
+
+	//minimax 13/6 rational approximation
+	constexpr float TanhAlpha[] = {
+		-2.76076847742355e-16f,
+		 2.00018790482477e-13f,
+		-8.60467152213735e-11f,
+		 5.12229709037114e-08f,
+		 1.48572235717979e-05f,
+		 6.37261928875436e-04f,
+		 4.89352455891786e-03f
+	};
+	constexpr float TanhBeta[] = {
+		1.19825839466702e-06f,
+		1.18534705686654e-04f,
+		2.26843463243900e-03f,
+		4.89352518554385e-03f
+	};
+
+	inline float FastTanh(float x) {
+		x = std::clamp(x, -TanhClamp, TanhClamp);
+		float x2 = x * x;
+
+		float p = TanhAlpha[0];
+		for (std::size_t i = 1; i < std::size(TanhAlpha); i++)
+			p = p * x2 + TanhAlpha[i];
+
+		float q = TanhBeta[0];
+		for (std::size_t i = 1; i < std::size(TanhBeta); i++)
+			q = q * x2 + TanhBeta[i];
+
+		return p * x / q;
+	}
+
+	inline float FastSigmoid(float x) {
+		return 0.5f + 0.5f * FastTanh(0.5f * x);
+	}
+
+#if MATRIX_KERNELS_SSE
+	inline __m128 FastTanh(__m128 x) {
+		x = _mm_min_ps(_mm_max_ps(x, _mm_set1_ps(-TanhClamp)), _mm_set1_ps(TanhClamp));
+		__m128 x2 = _mm_mul_ps(x, x);
+
+		__m128 p = _mm_set1_ps(TanhAlpha[0]);
+		for (std::size_t i = 1; i < std::size(TanhAlpha); i++)
+			p = _mm_add_ps(_mm_mul_ps(p, x2), _mm_set1_ps(TanhAlpha[i]));
+
+		__m128 q = _mm_set1_ps(TanhBeta[0]);
+		for (std::size_t i = 1; i < std::size(TanhBeta); i++)
+			q = _mm_add_ps(_mm_mul_ps(q, x2), _mm_set1_ps(TanhBeta[i]));
+
+		return _mm_div_ps(_mm_mul_ps(p, x), q);
+	}
+
+	inline __m128 FastSigmoid(__m128 x) {
+		const __m128 half = _mm_set1_ps(0.5f);
+		return _mm_add_ps(half, _mm_mul_ps(half, FastTanh(_mm_mul_ps(half, x))));
+	}
+#endif
+
+	struct FastTanhKernel {
+		float operator()(float x)const{ return FastTanh(x); }
+#if MATRIX_KERNELS_SSE
+		__m128 operator()(__m128 x)const{ return FastTanh(x); }
+#endif
+	};
+
+	struct FastSigmoidKernel {
+		float operator()(float x)const{ return FastSigmoid(x); }
+#if MATRIX_KERNELS_SSE
+		__m128 operator()(__m128 x)const{ return FastSigmoid(x); }
+#endif
+	};
+
+	//data[i] = kernel(data[i] - biases[i])
+	template<typename KernelType>
+	inline void Apply(float *data, const float *biases, std::size_t count, KernelType kernel) {
+		std::size_t i = 0;
+#if MATRIX_KERNELS_SSE
+		for (; i + 4 <= count; i += 4) {
+			__m128 value = _mm_sub_ps(_mm_loadu_ps(data + i), _mm_loadu_ps(biases + i));
+			_mm_storeu_ps(data + i, kernel(value));
+		}
+#endif
+		for (; i < count; i++) {
+			data[i] = kernel(data[i] - biases[i]);
+		}
+	}
+
+	//exact variants give the same results as calling the activation function per element
+	inline void BiasActivate(Activation activation, bool fast, float (*function)(float), float *data, const float *biases, std::size_t count) {
+		switch (activation) {
+		case Activation::None:
+			for (std::size_t i = 0; i < count; i++)
+				data[i] -= biases[i];
+			return;
+		case Activation::Tanh:
+			if(fast)
+				return Apply(data, biases, count, FastTanhKernel());
+			for (std::size_t i = 0; i < count; i++)
+				data[i] = std::tanh(data[i] - biases[i]);
+			return;
+		case Activation::Sigmoid:
+			if(fast)
+				return Apply(data, biases, count, FastSigmoidKernel());
+			for (std::size_t i = 0; i < count; i++)
+				data[i] = 1.f / (1.f + std::exp(-(data[i] - biases[i])));
+			return;
+		default:
+			for (std::size_t i = 0; i < count; i++)
+				data[i] = function(data[i] - biases[i]);
+			return;
+		}
+	}
+
+	//gradient[i] *= f'(x) where output[i] = f(x), derivatives are expressed through the output
+	//so backward pass needs no extra activation calls. Custom has no such form and is left untouched
+	inline void MultiplyDerivative(Activation activation, const float *output, float *gradient, std::size_t count) {
+		switch (activation) {
+		case Activation::Tanh:
+			for (std::size_t i = 0; i < count; i++)
+				gradient[i] *= 1.f - output[i] * output[i];
+			return;
+		case Activation::Sigmoid:
+			for (std::size_t i = 0; i < count; i++)
+				gradient[i] *= output[i] * (1.f - output[i]);
+			return;
+		default:
+			return;
+		}
+	}
+}
@@ -15,6 +15,20 @@ namespace Math{
 	inline float None(float x) {
 		return x;
 	}
+
+	inline float SigmoidDerivative(float x) {
+		float s = Sigmoid(x);
+		return s * (1.f - s);
+	}
+
+	inline float TanhDerivative(float x) {
+		float t = std::tanh(x);
+		return 1.f - t * t;
+	}
+
+	inline float NoneDerivative(float /*x*/) {
+		return 1.f;
+	}
 	
 	template<typename T>
 	T Sign(T value) {
@@ -2,13 +2,19 @@
 
 #include <cassert>
 #include <cstdint>
+#include <cstring>
+#include <new>
 #include <vector>
 #include <cmath>
+#include <utility>
+#include <type_traits>
 #include <ostream>
 #include <istream>
 
 #include "bsl/serialization_std.hpp"
 #include "bsl/assert.hpp"
+#include "matrix_kernels.hpp"
+#include "random.hpp"
 
 #undef assert
 #define assert verify
@@ -33,24 +39,124 @@ public:
 	}
 };
 
+template<typename Type>
+class Matrix;
+
+//Elementwise expressions are kept lazy and evaluated in a single pass when assigned to a Matrix,
+//so chains like a - b * s allocate nothing but the result
+template<typename T>
+struct IsMatrixExpression: std::false_type {};
+
+template<typename T>
+struct IsMatrixExpression<Matrix<T>>: std::true_type {};
+
+template<typename T>
+constexpr bool IsMatrixExpressionV = IsMatrixExpression<std::decay_t<T>>::value;
+
+//named matrices and expressions are held by reference, temporaries are moved into the node
+template<typename T>
+using MatrixOperand = std::conditional_t<std::is_lvalue_reference_v<T>, const std::remove_reference_t<T>&, std::decay_t<T>>;
+
+struct MatrixAdd {
+	template<typename T>
+	static T Apply(T left, T right){ return left + right; }
+};
+
+struct MatrixSubtract {
+	template<typename T>
+	static T Apply(T left, T right){ return left - right; }
+};
+
+template<typename Operation, typename Left, typename Right>
+class MatrixBinaryExpression {
+	Left m_Left;
+	Right m_Right;
+public:
+	using ValueType = typename std::decay_t<Left>::ValueType;
+
+	template<typename L, typename R>
+	MatrixBinaryExpression(L &&left, R &&right):
+		m_Left(std::forward<L>(left)),
+		m_Right(std::forward<R>(right))
+	{
+		assert(m_Left.N() == m_Right.N() && m_Left.M() == m_Right.M());
+	}
+
+	size_t N()const{ return m_Left.N(); }
+
+	size_t M()const{ return m_Left.M(); }
+
+	ValueType Element(size_t index)const{
+		return Operation::Apply(m_Left.Element(index), m_Right.Element(index));
+	}
+};
+
+template<typename Inner>
+class MatrixScaledExpression {
+	Inner m_Operand;
+public:
+	using ValueType = typename std::decay_t<Inner>::ValueType;
+private:
+	ValueType m_Scale;
+public:
+	template<typename O>
+	MatrixScaledExpression(O &&operand, ValueType scale):
+		m_Operand(std::forward<O>(operand)),
+		m_Scale(scale)
+	{}
+
+	size_t N()const{ return m_Operand.N(); }
+
+	size_t M()const{ return m_Operand.M(); }
+
+	ValueType Element(size_t index)const{
+		return m_Operand.Element(index) * m_Scale;
+	}
+
+	const std::decay_t<Inner> &Operand()const{ return m_Operand; }
+
+	ValueType Scale()const{ return m_Scale; }
+};
+
+template<typename Operation, typename Left, typename Right>
+struct IsMatrixExpression<MatrixBinaryExpression<Operation, Left, Right>>: std::true_type {};
+
+template<typename Inner>
+struct IsMatrixExpression<MatrixScaledExpression<Inner>>: std::true_type {};
+
+//Construction tag for matrices that are fully overwritten right away
+struct UninitializedTag {};
+
+constexpr UninitializedTag Uninitialized{};
+
 template<typename Type>
 class Matrix{
-	Type *m_Data = nullptr;
+	static_assert(std::is_trivially_copyable_v<Type>, "Matrix elements are copied and zeroed as raw memory");
+public:
+	//heap storage is aligned for SIMD loads and never shares a cache line
+	static constexpr size_t Alignment = 64;
+	//biases and small layers live inside the matrix itself, only 16 byte aligned
+	static constexpr size_t InlineCount = 128 / sizeof(Type) ? 128 / sizeof(Type) : 1;
+private:
 	size_t m_N = 0;
 	size_t m_M = 0;
+	//inline buffer reuses the pointer bytes, IsInline() tells which one is used
+	union alignas(16) {
+		Type *m_Heap = nullptr;
+		Type m_Inline[InlineCount];
+	};
 public:
 	Matrix() = default;
 
-	Matrix(size_t n, size_t m): 
-		m_N(n), 
-		m_M(m) 
-	{ 
-		if(!n || !m)
-			return;
-
-		m_Data = new Type[m_N * m_M];
+	Matrix(size_t n, size_t m, UninitializedTag) {
+		Allocate(n, m);
+	}
 
-		std::memset(m_Data, 0, Count() * sizeof(Type));
+	Matrix(size_t n, size_t m):
+		Matrix(n, m, Uninitialized)
+	{ 
+		if(Count())
+			std::memset(Data(), 0, Count() * sizeof(Type));
 	}
 
 	Matrix(Matrix&& other)noexcept{
@@ -60,59 +166,139 @@ public:
 	~Matrix(){
 		Clear();
 	}
+
 	Matrix &operator=(Matrix&& other)noexcept{
+		if(this == &other)
+			return *this;
+
 		Clear();
-		std::swap(m_Data, other.m_Data);
-		std::swap(m_N, other.m_N);
-		std::swap(m_M, other.m_M);
+
+		if (other.IsInline()) {
+			Allocate(other.m_N, other.m_M);
+			std::copy(other.Data(), other.Data() + Count(), Data());
+			other.Clear();
+		} else {
+			m_Heap = other.m_Heap;
+			std::swap(m_N, other.m_N);
+			std::swap(m_M, other.m_M);
+			other.m_Heap = nullptr;
+		}
 
 		return *this;
 	}
 
-	    // Copy constructor
-    Matrix(const Matrix& other) : m_N(other.m_N), m_M(other.m_M) {
-        if (!m_N || !m_M)
-            return;
+	Matrix(const Matrix& other):
+		Matrix(other.m_N, other.m_M, Uninitialized)
+	{
+		std::copy(other.Data(), other.Data() + Count(), Data());
+	}
 
-        m_Data = new Type[m_N * m_M];
-        std::copy(other.m_Data, other.m_Data + m_N * m_M, m_Data);
-    }
+	//storage is reused when shapes match
+	Matrix& operator=(const Matrix& other) {
+		if(this == &other)
+			return *this;
 
-    // Copy assignment operator
-    Matrix& operator=(const Matrix& other) {
-        if (this != &other) {
-            Clear();
+		if (N() != other.N() || M() != other.M()) {
+			Clear();
+			Allocate(other.m_N, other.m_M);
+		}
 
-            m_N = other.m_N;
-            m_M = other.m_M;
+		std::copy(other.Data(), other.Data() + Count(), Data());
 
-            if (m_N && m_M) {
-                m_Data = new Type[m_N * m_M];
-                std::copy(other.m_Data, other.m_Data + m_N * m_M, m_Data);
-            }
-        }
+		return *this;
+	}
 
-        return *this;
-    }
+	using ValueType = Type;
+
+	template<typename Expression, typename = std::enable_if_t<IsMatrixExpressionV<Expression> && !std::is_same_v<Expression, Matrix>>>
+	Matrix(const Expression &expression):
+		Matrix(expression.N(), expression.M(), Uninitialized)
+	{
+		Assign(expression);
+	}
+
+	//elementwise expressions may read this matrix, each element is read before it is written
+	template<typename Expression, typename = std::enable_if_t<IsMatrixExpressionV<Expression> && !std::is_same_v<Expression, Matrix>>>
+	Matrix &operator=(const Expression &expression) {
+		if(N() != expression.N() || M() != expression.M())
+			return *this = Matrix(expression);
+
+		Assign(expression);
+		return *this;
+	}
+
+	template<typename Expression, typename = std::enable_if_t<IsMatrixExpressionV<Expression>>>
+	Matrix &operator+=(const Expression &expression) {
+		assert(N() == expression.N() && M() == expression.M());
+
+		Type *data = Data();
+		for (size_t i = 0; i < Count(); i++)
+			data[i] += expression.Element(i);
+
+		return *this;
+	}
+
+	template<typename Expression, typename = std::enable_if_t<IsMatrixExpressionV<Expression>>>
+	Matrix &operator-=(const Expression &expression) {
+		assert(N() == expression.N() && M() == expression.M());
+
+		Type *data = Data();
+		for (size_t i = 0; i < Count(); i++)
+			data[i] -= expression.Element(i);
+
+		return *this;
+	}
+
+	//a += b * s and a -= b * s go straight to the axpy kernel
+	Matrix &operator+=(const MatrixScaledExpression<const Matrix&> &expression) {
+		return Axpy(expression.Scale(), expression.Operand());
+	}
+
+	Matrix &operator-=(const MatrixScaledExpression<const Matrix&> &expression) {
+		return Axpy(-expression.Scale(), expression.Operand());
+	}
+
+	Matrix &operator*=(Type scale) {
+		Type *data = Data();
+		for (size_t i = 0; i < Count(); i++)
+			data[i] *= scale;
+
+		return *this;
+	}
+
+	//this += scale * x
+	Matrix &Axpy(Type scale, const Matrix &x) {
+		assert(N() == x.N() && M() == x.M());
+
+		if(&x == this)
+			return *this *= Type(1) + scale;
+
+		MatrixKernels::Axpy(scale, x.Data(), Data(), Count());
+		return *this;
+	}
+
+	Type Element(size_t index)const{
+		return Data()[index];
+	}
 
 	const Type &Get(size_t n, size_t m)const {
 		assert(n < N() && m < M());
-		return m_Data[m_M * n + m];
+		return Data()[m_M * n + m];
 	}
 
 	Type &Get(size_t n, size_t m){
 		assert(n < N() && m < M());
-		return m_Data[m_M * n + m];
+		return Data()[m_M * n + m];
 	}
 
 	Columns<const Type> operator[](size_t n)const{
 		assert(n < m_N);
-		return {&m_Data[n * m_M], m_M};
+		return {&Data()[n * m_M], m_M};
 	}
 
 	Columns<Type> operator[](size_t n){
 		assert(n < m_N);
-		return {&m_Data[n * m_M], m_M};
+		return {&Data()[n * m_M], m_M};
 	}
 
 	Matrix<Type> Transpose() const;
@@ -129,19 +315,32 @@ public:
 		return M() * N();
 	}
 
+	template<typename Expression>
+	void Assign(const Expression &expression) {
+		Type *data = Data();
+		for (size_t i = 0; i < Count(); i++)
+			data[i] = expression.Element(i);
+	}
+
 	void Clear() {
-		delete[] m_Data;
+		if(!IsInline() && m_Heap)
+			::operator delete(m_Heap, std::align_val_t(Alignment));
 		m_N = 0;
 		m_M = 0;
-		m_Data = nullptr;
+		m_Heap = nullptr;
+	}
+
+	bool IsInline()const{
+		return Count() && Count() <= InlineCount;
 	}
 
+	//nullptr for empty matrices
 	Type* Data() {
-		return m_Data;
+		return IsInline() ? m_Inline : m_Heap;
 	}
 
 	const Type* Data()const{
-		return m_Data;
+		return IsInline() ? m_Inline : m_Heap;
 	}
 	
 	template<typename Predicate>
@@ -153,7 +352,7 @@ public:
 
 	template<typename Predicate>
 	Matrix<Type> Transformed(Predicate pred)const{
-		Matrix<Type> result(N(), M());
+		Matrix<Type> result(N(), M(), Uninitialized);
 
 		for (int i = 0; i < Count(); i++)
 			result.Data()[i] = pred(Data()[i]);
@@ -171,49 +370,63 @@ public:
 	}
 		
 	static Matrix<Type> Random(size_t n, size_t m, Type min, Type max) {
-		Matrix<Type> result(n, m);
-
-		result.ForEach([&](Type& e) {
-			e = GetRandom<Type>(min, max);
-		});
+		Matrix<Type> result(n, m, Uninitialized);
+
+		if constexpr (std::is_same_v<Type, float>) {
+			RandomGenerator::ThisThread().Fill(result.Data(), result.Count(), min, max);
+		} else {
+			result.ForEach([&](Type& e) {
+				e = GetRandom<Type>(min, max);
+			});
+		}
 
 		return result;
 	}
+
+private:
+	void Allocate(size_t n, size_t m) {
+		m_N = n;
+		m_M = m;
+
+		if(!Count())
+			return;
+
+		if(!IsInline())
+			m_Heap = static_cast<Type*>(::operator new(Count() * sizeof(Type), std::align_val_t(Alignment)));
+	}
 };
 
 template<typename T>
 Matrix<T> operator*(const Matrix<T> &a, const Matrix<T> &b) {
     assert(a.M() == b.N());
 
-    Matrix<T> result(a.N(), b.M());
+    Matrix<T> result(a.N(), b.M(), Uninitialized);
 
-    for (size_t i = 0; i < a.N(); ++i) {
-        for (size_t j = 0; j < b.M(); ++j) {
-            T sum = 0;
-            for (size_t k = 0; k < a.M(); ++k) {
-                sum += a[i][k] * b[k][j];
-            }
-            result[i][j] = sum;
-        }
-    }
+    if(!result.Count())
+        return result;
+
+    //layers always multiply a single row by weights
+    if (a.N() == 1)
+        MatrixKernels::Gemv(a.Data(), b.Data(), result.Data(), a.M(), b.M());
+    else
+        MatrixKernels::Gemm(a.Data(), b.Data(), result.Data(), a.N(), a.M(), b.M());
 
     return result;
 }
 
-template<typename T>
-Matrix<T> operator*(const Matrix<T>& a, float scalar) {
-    Matrix<T> result(a.N(), a.M());
-    for (size_t i = 0; i < a.N(); ++i) {
-        for (size_t j = 0; j < a.M(); ++j) {
-            result[i][j] = a[i][j] * scalar;
-        }
-    }
-    return result;
+template<typename Expression, typename = std::enable_if_t<IsMatrixExpressionV<Expression>>>
+auto operator*(Expression &&expression, typename std::decay_t<Expression>::ValueType scalar) {
+    return MatrixScaledExpression<MatrixOperand<Expression>>(std::forward<Expression>(expression), scalar);
+}
+
+template<typename Expression, typename = std::enable_if_t<IsMatrixExpressionV<Expression>>>
+auto operator*(typename std::decay_t<Expression>::ValueType scalar, Expression &&expression) {
+    return MatrixScaledExpression<MatrixOperand<Expression>>(std::forward<Expression>(expression), scalar);
 }
 
 template<typename T>
 Matrix<T> Matrix<T>::Transpose() const{
-    Matrix<T> result(M(), N());
+    Matrix<T> result(M(), N(), Uninitialized);
     for (size_t i = 0; i < N(); ++i) {
         for (size_t j = 0; j < M(); ++j) {
             result[j][i] = Get(i, j);
@@ -222,38 +435,14 @@ Matrix<T> Matrix<T>::Transpose() const{
     return result;
 }
 
-template<typename T>
-Matrix<T> operator-(const Matrix<T>& a, const Matrix<T>& b) {
-    assert (!(a.N() != b.N() || a.M() != b.M()));
-
-    // Create a new matrix to store the result
-    Matrix<T> result(a.N(), a.M());
-
-    // Perform matrix subtraction
-    for (size_t i = 0; i < a.N(); ++i) {
-        for (size_t j = 0; j < a.M(); ++j) {
-            result[i][j] = a[i][j] - b[i][j];
-        }
-    }
-
-    return result;
+template<typename Left, typename Right, typename = std::enable_if_t<IsMatrixExpressionV<Left> && IsMatrixExpressionV<Right>>>
+auto operator-(Left &&left, Right &&right) {
+    return MatrixBinaryExpression<MatrixSubtract, MatrixOperand<Left>, MatrixOperand<Right>>(std::forward<Left>(left), std::forward<Right>(right));
 }
 
-template<typename T>
-Matrix<T> operator+(const Matrix<T>& a, const Matrix<T>& b) {
-    assert (!(a.N() != b.N() || a.M() != b.M()));
-
-    // Create a new matrix to store the result
-    Matrix<T> result(a.N(), a.M());
-
-    // Perform matrix subtraction
-    for (size_t i = 0; i < a.N(); ++i) {
-        for (size_t j = 0; j < a.M(); ++j) {
-            result[i][j] = a[i][j] + b[i][j];
-        }
-    }
-
-    return result;
+template<typename Left, typename Right, typename = std::enable_if_t<IsMatrixExpressionV<Left> && IsMatrixExpressionV<Right>>>
+auto operator+(Left &&left, Right &&right) {
+    return MatrixBinaryExpression<MatrixAdd, MatrixOperand<Left>, MatrixOperand<Right>>(std::forward<Left>(left), std::forward<Right>(right));
 }
 
 template<typename Type>
@@ -275,6 +464,7 @@ bool operator==(const Matrix<Type>& lhs, const Matrix<Type>& rhs) {
     return true;
 }
 
+//Same stream format as writing every element through Serializer<T>, arithmetic payloads go as one block
 template<typename T>
 struct Serializer<Matrix<T>>{
 
@@ -282,8 +472,12 @@ struct Serializer<Matrix<T>>{
 		Serializer<std::size_t>::ToStream(matrix.N(), stream);
 		Serializer<std::size_t>::ToStream(matrix.M(), stream);
 
-		for (auto i = 0; i < matrix.Count(); i++)
-			Serializer<T>::ToStream(matrix.Data()[i], stream);
+		if constexpr (std::is_arithmetic_v<T>) {
+			stream.write(reinterpret_cast<const char*>(matrix.Data()), matrix.Count() * sizeof(T));
+		} else {
+			for (size_t i = 0; i < matrix.Count(); i++)
+				Serializer<T>::ToStream(matrix.Data()[i], stream);
+		}
 	}
 
 	static std::optional<Matrix<T>> FromStream(std::istream& stream) {
@@ -294,15 +488,20 @@ struct Serializer<Matrix<T>>{
 		if(!n.has_value() || !m.has_value())
 			return std::nullopt;
 
-		Matrix<T> matrix(n.value(), m.value());
-		
-		for (auto i = 0; i < matrix.Count(); i++){
-			auto e = Serializer<T>::FromStream(stream);
+		Matrix<T> matrix(n.value(), m.value(), Uninitialized);
 
-			if(!e.has_value())
+		if constexpr (std::is_arithmetic_v<T>) {
+			if(!stream.read(reinterpret_cast<char*>(matrix.Data()), matrix.Count() * sizeof(T)))
 				return std::nullopt;
+		} else {
+			for (size_t i = 0; i < matrix.Count(); i++){
+				auto e = Serializer<T>::FromStream(stream);
+
+				if(!e.has_value())
+					return std::nullopt;
 
-			matrix.Data()[i] = std::move(e.value());
+				matrix.Data()[i] = std::move(e.value());
+			}
 		}
 		
 		return {std::move(matrix)};
@@ -0,0 +1,190 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+	#include <emmintrin.h>
+	#define MATRIX_KERNELS_SSE 1
+#else
+	#define MATRIX_KERNELS_SSE 0
+#endif
+
+#if defined(_MSC_VER)
+	#define MATRIX_RESTRICT __restrict
+#else
+	#define MATRIX_RESTRICT __restrict__
+#endif
+
+//Raw row major kernels behind Matrix operations, bounds are checked once by the caller.
+//Every output element accumulates its products in the same order as the naive triple loop,
+//so results are bit exact with it
+namespace MatrixKernels {
+	//tile of B that is reused by all rows of A, 128 x 256 floats fit into L2
+	constexpr std::size_t BlockK = 128;
+	constexpr std::size_t BlockM = 256;
+
+	//y += scale * x
+	template<typename T>
+	inline void Axpy(T scale, const T * MATRIX_RESTRICT x, T * MATRIX_RESTRICT y, std::size_t count) {
+		for (std::size_t j = 0; j < count; j++) {
+			y[j] += scale * x[j];
+		}
+	}
+
+#if MATRIX_KERNELS_SSE
+	template<>
+	inline void Axpy<float>(float scale, const float * MATRIX_RESTRICT x, float * MATRIX_RESTRICT y, std::size_t count) {
+		const __m128 s = _mm_set1_ps(scale);
+
+		std::size_t j = 0;
+		for (; j + 8 <= count; j += 8) {
+			__m128 y0 = _mm_add_ps(_mm_loadu_ps(y + j), _mm_mul_ps(s, _mm_loadu_ps(x + j)));
+			__m128 y1 = _mm_add_ps(_mm_loadu_ps(y + j + 4), _mm_mul_ps(s, _mm_loadu_ps(x + j + 4)));
+			_mm_storeu_ps(y + j, y0);
+			_mm_storeu_ps(y + j + 4, y1);
+		}
+		for (; j + 4 <= count; j += 4) {
+			_mm_storeu_ps(y + j, _mm_add_ps(_mm_loadu_ps(y + j), _mm_mul_ps(s, _mm_loadu_ps(x + j))));
+		}
+		for (; j < count; j++) {
+			y[j] += scale * x[j];
+		}
+	}
+#endif
+
+	//y = x * b, x is 1 x k, b is k x m
+	template<typename T>
+	inline void Gemv(const T *x, const T *b, T *y, std::size_t k, std::size_t m) {
+		std::fill(y, y + m, T(0));
+
+		for (std::size_t i = 0; i < k; i++) {
+			Axpy(x[i], b + i * m, y, m);
+		}
+	}
+
+	//Independent y = x * b for lanes networks at once, lanes is a multiple of 4.
+	//Element of every lane is interleaved: x[i * lanes + a], b[(i * m + j) * lanes + a], y[j * lanes + a].
+	//Each lane accumulates in the same order as Gemv, so results are bit exact with it
+	inline void BatchedGemv(const float * MATRIX_RESTRICT x, const float * MATRIX_RESTRICT b, float * MATRIX_RESTRICT y, std::size_t k, std::size_t m, std::size_t lanes) {
+		std::fill(y, y + m * lanes, 0.f);
+
+		for (std::size_t i = 0; i < k; i++) {
+			const float *x_row = x + i * lanes;
+			const float *b_row = b + i * m * lanes;
+
+			for (std::size_t j = 0; j < m; j++) {
+				const float *b_lanes = b_row + j * lanes;
+				float *y_lanes = y + j * lanes;
+
+				std::size_t a = 0;
+#if MATRIX_KERNELS_SSE
+				for (; a + 4 <= lanes; a += 4) {
+					__m128 product = _mm_mul_ps(_mm_loadu_ps(x_row + a), _mm_loadu_ps(b_lanes + a));
+					_mm_storeu_ps(y_lanes + a, _mm_add_ps(_mm_loadu_ps(y_lanes + a), product));
+				}
+#endif
+				for (; a < lanes; a++) {
+					y_lanes[a] += x_row[a] * b_lanes[a];
+				}
+			}
+		}
+	}
+
+	//c = a * b, a is n x k, b is k x m
+	template<typename T>
+	inline void Gemm(const T *a, const T *b, T *c, std::size_t n, std::size_t k, std::size_t m) {
+		std::fill(c, c + n * m, T(0));
+
+		for (std::size_t kk = 0; kk < k; kk += BlockK) {
+			const std::size_t k_end = std::min(kk + BlockK, k);
+
+			for (std::size_t jj = 0; jj < m; jj += BlockM) {
+				const std::size_t width = std::min(BlockM, m - jj);
+
+				for (std::size_t row = 0; row < n; row++) {
+					const T *a_row = a + row * k;
+					T *c_row = c + row * m + jj;
+
+					for (std::size_t i = kk; i < k_end; i++) {
+						Axpy(a_row[i], b + i * m + jj, c_row, width);
+					}
+				}
+			}
+		}
+	}
+
+	//c = transpose(a) * b, a is n x k, b is n x m, c is k x m
+	template<typename T>
+	inline void GemmTransposedA(const T *a, const T *b, T *c, std::size_t n, std::size_t k, std::size_t m) {
+		std::fill(c, c + k * m, T(0));
+
+		for (std::size_t row = 0; row < n; row++) {
+			const T *a_row = a + row * k;
+			const T *b_row = b + row * m;
+
+			for (std::size_t i = 0; i < k; i++) {
+				Axpy(a_row[i], b_row, c + i * m, m);
+			}
+		}
+	}
+
+	//c = a * transpose(b), a is n x m, b is k x m, c is n x k
+	template<typename T>
+	inline void GemmTransposedB(const T *a, const T *b, T *c, std::size_t n, std::size_t m, std::size_t k) {
+		for (std::size_t row = 0; row < n; row++) {
+			const T *a_row = a + row * m;
+
+			for (std::size_t i = 0; i < k; i++) {
+				const T *b_row = b + i * m;
+
+				T sum = 0;
+				for (std::size_t j = 0; j < m; j++) {
+					sum += a_row[j] * b_row[j];
+				}
+				c[row * k + i] = sum;
+			}
+		}
+	}
+
+	//Quantized y = x * b with int32 accumulation, values are int8 range kept in int16 so they feed madd directly.
+	//Inputs go in pairs packed as (x[2p + 1] << 16) | x[2p] int16 halves,
+	//b is blocked for 4 outputs: b[((j / 4) * pairs + p) * 8 + (j % 4) * 2 + {0, 1}] = {b[2p][j], b[2p + 1][j]}.
+	//Integer sums are exact, so SIMD and scalar paths give the same result
+	inline void GemvInt16(const std::int32_t *x_pairs, const std::int16_t *b, std::int32_t *y, std::size_t pairs, std::size_t m) {
+		for (std::size_t jj = 0; jj < m; jj += 4) {
+			const std::int16_t *block = b + (jj / 4) * pairs * 8;
+			const std::size_t width = std::min<std::size_t>(4, m - jj);
+#if MATRIX_KERNELS_SSE
+			__m128i sum0 = _mm_setzero_si128();
+			__m128i sum1 = _mm_setzero_si128();
+
+			std::size_t p = 0;
+			for (; p + 2 <= pairs; p += 2) {
+				sum0 = _mm_add_epi32(sum0, _mm_madd_epi16(_mm_loadu_si128((const __m128i*)(block + p * 8)), _mm_set1_epi32(x_pairs[p])));
+				sum1 = _mm_add_epi32(sum1, _mm_madd_epi16(_mm_loadu_si128((const __m128i*)(block + p * 8 + 8)), _mm_set1_epi32(x_pairs[p + 1])));
+			}
+			if (p < pairs) {
+				sum0 = _mm_add_epi32(sum0, _mm_madd_epi16(_mm_loadu_si128((const __m128i*)(block + p * 8)), _mm_set1_epi32(x_pairs[p])));
+			}
+
+			alignas(16) std::int32_t lanes[4];
+			_mm_store_si128((__m128i*)lanes, _mm_add_epi32(sum0, sum1));
+			std::copy(lanes, lanes + width, y + jj);
+#else
+			for (std::size_t lane = 0; lane < width; lane++) {
+				std::int32_t sum = 0;
+
+				for (std::size_t p = 0; p < pairs; p++) {
+					const std::int16_t low = std::int16_t(x_pairs[p] & 0xFFFF);
+					const std::int16_t high = std::int16_t(std::uint32_t(x_pairs[p]) >> 16);
+
+					sum += low * block[p * 8 + lane * 2] + high * block[p * 8 + lane * 2 + 1];
+				}
+				y[jj + lane] = sum;
+			}
+#endif
+		}
+	}
+}
@@ -0,0 +1,431 @@
+#include "model_file.hpp"
+#include <fstream>
+#include <cstring>
+#include <charconv>
+#include <algorithm>
+
+#ifdef _WIN32
+	#define WIN32_LEAN_AND_MEAN
+	#define NOMINMAX
+	#include <windows.h>
+#else
+	#include <fcntl.h>
+	#include <unistd.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+#endif
+
+static std::size_t AlignUp(std::size_t value, std::size_t alignment) {
+	return (value + alignment - 1) / alignment * alignment;
+}
+
+static std::size_t ElementSize(TensorType type) {
+	switch (type) {
+	case TensorType::Float32: return sizeof(float);
+	case TensorType::Int8: return sizeof(std::int8_t);
+	case TensorType::Int32: return sizeof(std::int32_t);
+	case TensorType::Char: return sizeof(char);
+	}
+	return 0;
+}
+
+//FNV-1a of zero terminated name
+static std::size_t NameHash(const char *name) {
+	std::uint64_t hash = 14695981039346656037ull;
+
+	for (; *name; name++) {
+		hash ^= std::uint8_t(*name);
+		hash *= 1099511628211ull;
+	}
+
+	return std::size_t(hash);
+}
+
+static std::string LayerName(const std::string &prefix, std::size_t index, const char *tensor) {
+	return prefix + "/" + std::to_string(index) + "/" + tensor;
+}
+
+bool ModelWriter::Add(const std::string& name, const Matrix<float>& matrix) {
+	return Add(name, TensorType::Float32, matrix.N(), matrix.M(), matrix.Data(), matrix.Count() * sizeof(float));
+}
+
+bool ModelWriter::Add(const std::string& name, const std::string& text) {
+	return Add(name, TensorType::Char, 1, text.size(), text.data(), text.size());
+}
+
+bool ModelWriter::Add(const std::string& prefix, const NeuralNetwork& network) {
+	//"function" is the longest layer tensor name and the last layer has the longest index
+	const std::size_t last = network.Layers().size() ? network.Layers().size() - 1 : 0;
+
+	if(!FitsName(prefix + "/functions") || !FitsName(LayerName(prefix, last, "function")))
+		return false;
+
+	std::string functions;
+	for (const std::string &function : network.Functions()) {
+		if(functions.size())
+			functions += '\n';
+		functions += function;
+	}
+	Add(prefix + "/functions", functions);
+
+	for (std::size_t l = 0; l < network.Layers().size(); l++) {
+		const Layer &layer = network.Layers()[l];
+
+		Add(LayerName(prefix, l, "weights"), layer.Weights());
+		Add(LayerName(prefix, l, "biases"), layer.Biases());
+		Add(LayerName(prefix, l, "function"), layer.FunctionName());
+	}
+
+	return true;
+}
+
+bool ModelWriter::Add(const std::string& name, TensorType type, std::size_t n, std::size_t m, const void* data, std::size_t bytes) {
+	if(!FitsName(name))
+		return false;
+
+	TensorEntry entry;
+	std::memcpy(entry.Name, name.data(), std::min(name.size(), TensorEntry::NameLength - 1));
+	entry.Type = type;
+	entry.N = n;
+	entry.M = m;
+	entry.Offset = AlignUp(m_Payload.size(), TensorAlignment);
+
+	m_Payload.resize(entry.Offset + bytes);
+	if(bytes)
+		std::memcpy(m_Payload.data() + entry.Offset, data, bytes);
+
+	m_Entries.push_back(entry);
+	return true;
+}
+
+bool ModelWriter::Save(const std::string& path)const {
+	std::fstream file(path, std::ios::binary | std::ios::out);
+
+	if(!file.is_open())
+		return false;
+
+	const std::size_t data_begin = AlignUp(sizeof(ModelFileHeader) + m_Entries.size() * sizeof(TensorEntry), TensorAlignment);
+
+	ModelFileHeader header;
+	header.Magic = Magic;
+	header.Version = Version;
+	header.TensorsCount = m_Entries.size();
+	header.Size = data_begin + m_Payload.size();
+
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+	for (TensorEntry entry : m_Entries) {
+		entry.Offset += data_begin;
+		file.write(reinterpret_cast<const char*>(&entry), sizeof(entry));
+	}
+
+	const std::vector<char> padding(data_begin - sizeof(ModelFileHeader) - m_Entries.size() * sizeof(TensorEntry), 0);
+	file.write(padding.data(), padding.size());
+	file.write(m_Payload.data(), m_Payload.size());
+
+	return bool(file);
+}
+
+MappedModel::MappedModel(MappedModel&& other)noexcept {
+	*this = std::move(other);
+}
+
+MappedModel::~MappedModel() {
+	Close();
+}
+
+MappedModel& MappedModel::operator=(MappedModel&& other)noexcept {
+	if(this == &other)
+		return *this;
+
+	Close();
+	std::swap(m_Data, other.m_Data);
+	std::swap(m_Size, other.m_Size);
+	std::swap(m_File, other.m_File);
+	std::swap(m_Mapping, other.m_Mapping);
+	std::swap(m_Buckets, other.m_Buckets);
+
+	return *this;
+}
+
+bool MappedModel::Open(const std::string& path) {
+	Close();
+
+#ifdef _WIN32
+	HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if(file == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER size;
+	HANDLE mapping = GetFileSizeEx(file, &size) && size.QuadPart ? CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr) : nullptr;
+	const void *data = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+
+	if (!data) {
+		if(mapping)
+			CloseHandle(mapping);
+		CloseHandle(file);
+		return false;
+	}
+
+	m_File = file;
+	m_Mapping = mapping;
+	m_Size = std::size_t(size.QuadPart);
+#else
+	int file = open(path.c_str(), O_RDONLY);
+	if(file < 0)
+		return false;
+
+	struct stat status;
+	void *data = fstat(file, &status) == 0 && status.st_size ? mmap(nullptr, status.st_size, PROT_READ, MAP_PRIVATE, file, 0) : MAP_FAILED;
+	//mapping keeps its own reference to the file
+	close(file);
+
+	if(data == MAP_FAILED)
+		return false;
+
+	m_Size = std::size_t(status.st_size);
+#endif
+	m_Data = static_cast<const char*>(data);
+
+	if (!IsValid()) {
+		Close();
+		return false;
+	}
+
+	//at most half full
+	std::size_t buckets = 1;
+	while (buckets < Count() * 2)
+		buckets *= 2;
+
+	m_Buckets.assign(buckets, 0);
+	for (std::size_t i = 0; i < Count(); i++) {
+		std::size_t bucket = NameHash(Entry(i).Name) & (buckets - 1);
+
+		while (m_Buckets[bucket])
+			bucket = (bucket + 1) & (buckets - 1);
+
+		m_Buckets[bucket] = std::uint32_t(i + 1);
+	}
+
+	return true;
+}
+
+void MappedModel::Close() {
+	if (m_Data) {
+#ifdef _WIN32
+		UnmapViewOfFile(m_Data);
+		CloseHandle(m_Mapping);
+		CloseHandle(m_File);
+#else
+		munmap(const_cast<char*>(m_Data), m_Size);
+#endif
+	}
+
+	m_Data = nullptr;
+	m_Size = 0;
+	m_File = nullptr;
+	m_Mapping = nullptr;
+	m_Buckets.clear();
+}
+
+std::size_t MappedModel::Count()const {
+	return IsOpen() ? std::size_t(reinterpret_cast<const ModelFileHeader*>(m_Data)->TensorsCount) : 0;
+}
+
+std::string MappedModel::NameAt(std::size_t index)const {
+	return Entry(index).Name;
+}
+
+TensorView MappedModel::At(std::size_t index)const {
+	const TensorEntry &entry = Entry(index);
+
+	TensorView view;
+	view.Data = m_Data + entry.Offset;
+	view.Type = entry.Type;
+	view.N = std::size_t(entry.N);
+	view.M = std::size_t(entry.M);
+
+	return view;
+}
+
+std::optional<std::size_t> MappedModel::IndexOf(const std::string& name)const {
+	if(m_Buckets.empty())
+		return std::nullopt;
+
+	const std::size_t mask = m_Buckets.size() - 1;
+
+	for (std::size_t bucket = NameHash(name.c_str()) & mask; m_Buckets[bucket]; bucket = (bucket + 1) & mask) {
+		const std::size_t index = m_Buckets[bucket] - 1;
+
+		if(name == Entry(index).Name)
+			return index;
+	}
+
+	return std::nullopt;
+}
+
+std::optional<TensorView> MappedModel::Find(const std::string& name)const {
+	auto index = IndexOf(name);
+
+	if(!index.has_value())
+		return std::nullopt;
+
+	return At(index.value());
+}
+
+bool MappedModel::IsLayerAt(std::size_t index, const std::string& prefix, std::size_t layer)const {
+	static const char *const Tensors[] = {"weights", "biases", "function"};
+
+	if(index + std::size(Tensors) > Count())
+		return false;
+
+	//"<prefix>/<layer>/" is compared piece by piece, names are checked without allocations
+	char number[24];
+	const std::size_t digits = std::to_chars(number, number + sizeof(number), layer).ptr - number;
+
+	for (std::size_t i = 0; i < std::size(Tensors); i++) {
+		const char *name = Entry(index + i).Name;
+
+		//strncmp stops at the end of shorter name, so nothing past it is read
+		if(std::strncmp(name, prefix.c_str(), prefix.size()) != 0)
+			return false;
+
+		name += prefix.size();
+		if(name[0] != '/' || std::strncmp(name + 1, number, digits) != 0 || name[digits + 1] != '/' || std::strcmp(name + digits + 2, Tensors[i]) != 0)
+			return false;
+	}
+
+	return true;
+}
+
+std::optional<NeuralNetwork> MappedModel::LoadNetwork(const std::string& prefix)const {
+	auto network = MappedNetwork::FromModel(*this, prefix);
+	auto functions = IndexOf(prefix + "/functions");
+
+	if(!network.has_value() || !functions.has_value())
+		return std::nullopt;
+
+	std::vector<std::string> function_names;
+	std::string text = At(functions.value()).Text();
+	for (std::size_t begin = 0; begin <= text.size();) {
+		std::size_t end = std::min(text.find('\n', begin), text.size());
+		function_names.push_back(text.substr(begin, end - begin));
+		begin = end + 1;
+
+		if(text.size() && !ActivationFunction::Exists(function_names.back()))
+			return std::nullopt;
+	}
+
+	std::vector<Layer> layers;
+	std::vector<int> topology;
+
+	//FromModel has checked the same layers
+	for (std::size_t l = 0, index = functions.value() + 1; IsLayerAt(index, prefix, l); l++, index += 3) {
+		const TensorView weights = At(index);
+		const TensorView biases = At(index + 1);
+
+		Matrix<float> weights_copy(weights.N, weights.M, Uninitialized);
+		Matrix<float> biases_copy(biases.N, biases.M, Uninitialized);
+		std::copy(weights.Floats(), weights.Floats() + weights.Count(), weights_copy.Data());
+		std::copy(biases.Floats(), biases.Floats() + biases.Count(), biases_copy.Data());
+
+		if(topology.empty())
+			topology.push_back(int(weights.N));
+		topology.push_back(int(weights.M));
+
+		layers.emplace_back(std::move(weights_copy), std::move(biases_copy), At(index + 2).Text());
+	}
+
+	return {NeuralNetwork(std::move(layers), std::move(topology), std::move(function_names))};
+}
+
+const TensorEntry& MappedModel::Entry(std::size_t index)const {
+	assert(index < Count());
+	return reinterpret_cast<const TensorEntry*>(m_Data + sizeof(ModelFileHeader))[index];
+}
+
+bool MappedModel::IsValid()const {
+	if(m_Size < sizeof(ModelFileHeader))
+		return false;
+
+	const ModelFileHeader &header = *reinterpret_cast<const ModelFileHeader*>(m_Data);
+
+	if(header.Magic != ModelWriter::Magic || header.Version != ModelWriter::Version || header.Size != m_Size)
+		return false;
+
+	if(header.TensorsCount > (m_Size - sizeof(ModelFileHeader)) / sizeof(TensorEntry))
+		return false;
+
+	for (std::size_t i = 0; i < Count(); i++) {
+		const TensorEntry &entry = Entry(i);
+		const std::size_t element = ElementSize(entry.Type);
+
+		if(!element || entry.Name[TensorEntry::NameLength - 1] != 0 || entry.Offset % ModelWriter::TensorAlignment)
+			return false;
+
+		//checked by division so huge shapes can't overflow
+		if(entry.Offset > m_Size || (entry.N && entry.M > (m_Size - entry.Offset) / element / entry.N))
+			return false;
+	}
+
+	return true;
+}
+
+std::optional<MappedNetwork> MappedNetwork::FromModel(const MappedModel& model, const std::string& prefix) {
+	MappedNetwork network;
+	auto functions = model.IndexOf(prefix + "/functions");
+
+	if(!functions.has_value())
+		return std::nullopt;
+
+	for (std::size_t l = 0, index = functions.value() + 1; model.IsLayerAt(index, prefix, l); l++, index += 3) {
+		const TensorView weights = model.At(index);
+		const TensorView biases = model.At(index + 1);
+
+		if(!weights.Floats() || !biases.Floats() || biases.Count() != weights.M)
+			return std::nullopt;
+
+		if(network.m_Layers.size() && network.m_Layers.back().Outputs != weights.N)
+			return std::nullopt;
+
+		MappedLayer layer;
+		layer.Weights = weights.Floats();
+		layer.Biases = biases.Floats();
+		layer.Inputs = weights.N;
+		layer.Outputs = weights.M;
+		const std::string function_name = model.At(index + 2).Text();
+
+		if(!ActivationFunction::Exists(function_name))
+			return std::nullopt;
+
+		layer.Kind = ActivationFunction::FindKind(function_name);
+		layer.Function = ActivationFunction::Find(function_name);
+
+		if(network.m_Topology.empty())
+			network.m_Topology.push_back(int(layer.Inputs));
+		network.m_Topology.push_back(int(layer.Outputs));
+
+		network.m_Layers.push_back(layer);
+	}
+
+	if(network.m_Layers.empty())
+		return std::nullopt;
+
+	return {std::move(network)};
+}
+
+const float* MappedNetwork::Do(const float* input, InferenceWorkspace& workspace)const {
+	workspace.Reserve(m_Topology);
+
+	for (std::size_t i = 0; i < m_Layers.size(); i++) {
+		const MappedLayer &layer = m_Layers[i];
+		float *output = workspace.Buffer(i);
+
+		MatrixKernels::Gemv(input, layer.Weights, output, layer.Inputs, layer.Outputs);
+		ActivationKernels::BiasActivate(layer.Kind, m_FastMath, layer.Function, output, layer.Biases, layer.Outputs);
+
+		input = output;
+	}
+
+	return input;
+}
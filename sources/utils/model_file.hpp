@@ -0,0 +1,170 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <optional>
+#include "nn.hpp"
+
+//Versioned container of named tensors: ModelFileHeader, table of TensorEntry, then payloads each aligned
+//to TensorAlignment, so a memory mapped file gives aligned weights that are used in place.
+//Numbers are stored in native byte order
+enum class TensorType: std::uint32_t {
+	Float32 = 0,
+	Int8 = 1,
+	Int32 = 2,
+	Char = 3
+};
+
+struct ModelFileHeader {
+	std::uint32_t Magic = 0;
+	std::uint32_t Version = 0;
+	std::uint64_t TensorsCount = 0;
+	//whole file, payloads included
+	std::uint64_t Size = 0;
+	std::uint64_t Reserved = 0;
+};
+
+struct TensorEntry {
+	static constexpr std::size_t NameLength = 48;
+
+	//zero terminated
+	char Name[NameLength] = {};
+	TensorType Type = TensorType::Float32;
+	std::uint32_t Reserved = 0;
+	std::uint64_t N = 0;
+	std::uint64_t M = 0;
+	//from the beginning of the file
+	std::uint64_t Offset = 0;
+};
+
+static_assert(sizeof(ModelFileHeader) == 32 && sizeof(TensorEntry) == 80, "ModelFile layout should not depend on compiler");
+
+//Read only tensor, points into the mapped file
+struct TensorView {
+	const void *Data = nullptr;
+	TensorType Type = TensorType::Float32;
+	std::size_t N = 0;
+	std::size_t M = 0;
+
+	std::size_t Count()const{ return N * M; }
+
+	const float *Floats()const{ return Type == TensorType::Float32 ? static_cast<const float*>(Data) : nullptr; }
+
+	std::string Text()const{ return Type == TensorType::Char ? std::string(static_cast<const char*>(Data), Count()) : std::string(); }
+};
+
+class ModelWriter {
+	std::vector<TensorEntry> m_Entries;
+	//payloads offsets are relative to the data section until Save
+	std::vector<char> m_Payload;
+public:
+	static constexpr std::uint32_t Magic = 0x4D435644; //"DVCM"
+	static constexpr std::uint32_t Version = 1;
+	static constexpr std::size_t TensorAlignment = 64;
+
+	//false when name doesn't fit TensorEntry::Name, nothing is added then
+	bool Add(const std::string &name, const Matrix<float> &matrix);
+
+	bool Add(const std::string &name, const std::string &text);
+
+	//layers go as "<prefix>/<index>/weights", "<prefix>/<index>/biases" and "<prefix>/<index>/function",
+	//the functions list of the network as "<prefix>/functions" separated by new lines.
+	//False when prefix is too long for any of the names, nothing is added then
+	bool Add(const std::string &prefix, const NeuralNetwork &network);
+
+	bool Save(const std::string &path)const;
+
+	std::size_t Count()const{ return m_Entries.size(); }
+
+private:
+	bool Add(const std::string &name, TensorType type, std::size_t n, std::size_t m, const void *data, std::size_t bytes);
+
+	static bool FitsName(const std::string &name){ return name.size() < TensorEntry::NameLength; }
+};
+
+//Memory mapped model file, tensors are valid while it is open
+class MappedModel {
+	const char *m_Data = nullptr;
+	std::size_t m_Size = 0;
+	//platform handles of the mapping
+	void *m_File = nullptr;
+	void *m_Mapping = nullptr;
+	//open addressing table of tensor index + 1 by name hash, 0 is empty.
+	//Names are compared in the mapped table, so opening doesn't copy them
+	std::vector<std::uint32_t> m_Buckets;
+public:
+	MappedModel() = default;
+
+	MappedModel(const MappedModel &) = delete;
+
+	MappedModel(MappedModel &&other)noexcept;
+
+	~MappedModel();
+
+	MappedModel &operator=(const MappedModel &) = delete;
+
+	MappedModel &operator=(MappedModel &&other)noexcept;
+
+	//false when file can't be mapped or header and tensor table are not valid
+	bool Open(const std::string &path);
+
+	void Close();
+
+	bool IsOpen()const{ return m_Data != nullptr; }
+
+	std::size_t Count()const;
+
+	std::string NameAt(std::size_t index)const;
+
+	TensorView At(std::size_t index)const;
+
+	std::optional<std::size_t> IndexOf(const std::string &name)const;
+
+	std::optional<TensorView> Find(const std::string &name)const;
+
+	//true when weights, biases and function of the layer of a network written with ModelWriter::Add start at index.
+	//They follow "<prefix>/functions" in order, so a network is resolved with a single lookup
+	bool IsLayerAt(std::size_t index, const std::string &prefix, std::size_t layer)const;
+
+	//copy of a network written with ModelWriter::Add, nullopt for unknown activation functions too
+	std::optional<NeuralNetwork> LoadNetwork(const std::string &prefix)const;
+
+private:
+	const TensorEntry &Entry(std::size_t index)const;
+
+	bool IsValid()const;
+};
+
+//Forward pass straight over weights of a MappedModel, nothing is copied.
+//Math is the same as NeuralNetwork::Do, results are bit exact with the loaded network
+class MappedNetwork {
+	struct MappedLayer {
+		const float *Weights = nullptr;
+		const float *Biases = nullptr;
+		std::size_t Inputs = 0;
+		std::size_t Outputs = 0;
+		Activation Kind = Activation::Custom;
+		ActivationFunction::Ptr Function = nullptr;
+	};
+
+	std::vector<MappedLayer> m_Layers;
+	std::vector<int> m_Topology;
+	bool m_FastMath = false;
+public:
+	MappedNetwork() = default;
+
+	//model should stay open while the network is used, nullopt for unknown activation functions
+	static std::optional<MappedNetwork> FromModel(const MappedModel &model, const std::string &prefix);
+
+	//result is one of workspace buffers
+	const float *Do(const float *input, InferenceWorkspace &workspace = InferenceWorkspace::ThisThread())const;
+
+	std::size_t Inputs()const{ return m_Layers.size() ? m_Layers.front().Inputs : 0; }
+
+	std::size_t Outputs()const{ return m_Layers.size() ? m_Layers.back().Outputs : 0; }
+
+	void SetFastMath(bool fast_math){ m_FastMath = fast_math; }
+
+	bool FastMath()const{ return m_FastMath; }
+};
@@ -6,6 +6,7 @@
 #include "random.hpp"
 #include "nn.hpp"
 #include "math.hpp"
+#include <algorithm>
 
 namespace ActivationFunction {
 	using namespace Math;
@@ -16,6 +17,12 @@ namespace ActivationFunction {
 		{"None", None}
 	};
 
+	static std::map<std::string, ActivationFunction::Ptr> s_Derivatives{
+		{"Sigmoid", SigmoidDerivative},
+		{"Tanh", TanhDerivative},
+		{"None", NoneDerivative}
+	};
+
 	ActivationFunction::Ptr Find(const std::string& name) {
 		auto it = s_Functions.find(name);
 
@@ -24,36 +31,127 @@ namespace ActivationFunction {
 
 		return it->second;
 	}
+
+	bool Exists(const std::string& name) {
+		return s_Functions.count(name);
+	}
+
+	ActivationFunction::Ptr FindDerivative(const std::string& name) {
+		auto it = s_Derivatives.find(name);
+
+		//same fallback as Find, so unknown function stays identity in training too
+		if(it == s_Derivatives.end())
+			return NoneDerivative;
+
+		return it->second;
+	}
+
+	Activation FindKind(const std::string& name) {
+		if(name == "None")
+			return Activation::None;
+		if(name == "Tanh")
+			return Activation::Tanh;
+		if(name == "Sigmoid")
+			return Activation::Sigmoid;
+		return Activation::Custom;
+	}
+}
+
+
+
+InferenceWorkspace::InferenceWorkspace(const std::vector<int>& topology) {
+	Reserve(topology);
+}
+
+void InferenceWorkspace::Reserve(const std::vector<int>& topology) {
+	std::size_t widest = topology.size() ? *std::max_element(topology.begin(), topology.end()) : 0;
+
+	if(widest <= Capacity())
+		return;
+
+	for (auto &buffer : m_Buffers) {
+		buffer.resize(widest);
+	}
+}
+
+InferenceWorkspace& InferenceWorkspace::ThisThread() {
+	static thread_local InferenceWorkspace workspace;
+	return workspace;
 }
 
+TrainingWorkspace::TrainingWorkspace(const std::vector<int>& topology, std::size_t batch) {
+	Reserve(topology, batch);
+}
 
+void TrainingWorkspace::Reserve(const std::vector<int>& topology, std::size_t batch) {
+	if(batch <= m_Batch && topology == m_Topology)
+		return;
+
+	m_Batch = std::max(batch, topology == m_Topology ? m_Batch : 0);
+	m_Topology = topology;
+
+	const std::size_t layers = topology.size() ? topology.size() - 1 : 0;
+	std::size_t widest = topology.size() ? *std::max_element(topology.begin(), topology.end()) : 0;
+
+	m_Activations.resize(topology.size());
+	for (std::size_t i = 0; i < topology.size(); i++)
+		m_Activations[i].resize(m_Batch * topology[i]);
+
+	m_PreActivations.resize(layers);
+	m_WeightsGradients.resize(layers);
+	m_BiasesGradients.resize(layers);
+	for (std::size_t i = 0; i < layers; i++) {
+		m_PreActivations[i].resize(m_Batch * topology[i + 1]);
+		m_WeightsGradients[i].resize(topology[i] * topology[i + 1]);
+		m_BiasesGradients[i].resize(topology[i + 1]);
+	}
+
+	for (auto &delta : m_Deltas) {
+		delta.resize(m_Batch * widest);
+	}
+}
+
+TrainingWorkspace& TrainingWorkspace::ThisThread() {
+	static thread_local TrainingWorkspace workspace;
+	return workspace;
+}
 
 Layer::Layer(Matrix<float> weights, Matrix<float> biases, const std::string &function_name):
 	m_Weights(std::move(weights)),
 	m_Biases(std::move(biases)),
 	m_FunctionName(function_name),
-	m_Function(ActivationFunction::Find(function_name))
+	m_Function(ActivationFunction::Find(function_name)),
+	m_Derivative(ActivationFunction::FindDerivative(function_name)),
+	m_Activation(ActivationFunction::FindKind(function_name))
 {}
 
 Layer::Layer(int input_size, int output_size, ActivationFunction::Ptr function, const std::string &function_name) :
 		m_Weights(
-			Matrix<float>::Random(input_size, output_size, -20, 20)
+			Matrix<float>::Random(input_size, output_size, -InitialRange, InitialRange)
 		),
 		m_Biases(
-			Matrix<float>::Random(1, output_size, -20, 20)
+			Matrix<float>::Random(1, output_size, -InitialRange, InitialRange)
 		),
 		m_Function(function),
-		m_FunctionName(function_name)
+		m_Derivative(ActivationFunction::FindDerivative(function_name)),
+		m_FunctionName(function_name),
+		m_Activation(ActivationFunction::FindKind(function_name))
 	{}
 
 Matrix<float> Layer::Do(const Matrix<float>& input)const {
-	auto res = input * m_Weights - m_Biases;
+	Matrix<float> res = input * m_Weights - m_Biases;
 	res.ForEach([=](float& e) {
 		e = m_Function(e);
 	});
 	return res;
 }
 
+void Layer::Do(const float *input, float *output, bool fast_math)const {
+	MatrixKernels::Gemv(input, m_Weights.Data(), output, m_Weights.N(), m_Weights.M());
+
+	ActivationKernels::BiasActivate(m_Activation, fast_math, m_Function, output, m_Biases.Data(), m_Weights.M());
+}
+
 const Matrix<float>& Layer::Weights()const {
 	return m_Weights;
 }
@@ -83,40 +181,83 @@ bool Layer::IsComplete()const {
 	return Weights().Count() && Biases().Count();
 }
 
+//random numbers for a whole matrix are generated in bulk, buffers are reused by every call on the thread
+static float *RandomBuffer(std::size_t index, std::size_t count) {
+	static thread_local std::vector<float> buffers[2];
+
+	if(buffers[index].size() < count)
+		buffers[index].resize(count);
+
+	return buffers[index].data();
+}
+
 void Layer::Mix(Matrix<float>& output, const Matrix<float>& left, const Matrix<float>& right, float rate) {
-	output.ForEachIndexed([=](float& num, size_t i, size_t j) {
-		auto a = left.Get(i, j);
-		auto b = right.Get(i, j);
-		num = (GetRandom<float>(0, 1) < rate) ? a : b;
-	});
+	assert(output.Count() == left.Count() && output.Count() == right.Count());
+
+	float *roll = RandomBuffer(0, output.Count());
+	RandomGenerator::ThisThread().Fill(roll, output.Count(), 0, 1);
+
+	for (size_t i = 0; i < output.Count(); i++) {
+		output.Data()[i] = roll[i] < rate ? left.Data()[i] : right.Data()[i];
+	}
+}
+
+void Layer::Mutate(Matrix<float>& matrix, float chance, float range) {
+	float *roll = RandomBuffer(0, matrix.Count());
+	float *noise = RandomBuffer(1, matrix.Count());
+	RandomGenerator::ThisThread().Fill(roll, matrix.Count(), 0, 1);
+	RandomGenerator::ThisThread().Fill(noise, matrix.Count(), -range, range);
+
+	for (size_t i = 0; i < matrix.Count(); i++) {
+		matrix.Data()[i] += roll[i] < chance ? noise[i] : 0.f;
+	}
+}
+
+void Layer::Randomize() {
+	RandomGenerator::ThisThread().Fill(m_Weights.Data(), m_Weights.Count(), -InitialRange, InitialRange);
+	RandomGenerator::ThisThread().Fill(m_Biases.Data(), m_Biases.Count(), -InitialRange, InitialRange);
 }
 
 Layer Layer::Crossover(const Layer& parent1, const Layer& parent2) {
+	Layer child;
+	Crossover(parent1, parent2, child);
+	return child;
+}
+
+void Layer::Crossover(const Layer& parent1, const Layer& parent2, Layer& child) {
 	assert(parent1.IsComplete() && parent2.IsComplete());
 
-	Layer child(parent1.m_Weights.N(), parent1.m_Weights.M(), parent1.m_Function, parent1.m_FunctionName); // Create a child layer with the same size and function
+	//every element is picked from a parent, so no need to zero them first
+	if(child.m_Weights.N() != parent1.m_Weights.N() || child.m_Weights.M() != parent1.m_Weights.M())
+		child.m_Weights = Matrix<float>(parent1.m_Weights.N(), parent1.m_Weights.M(), Uninitialized);
+
+	if(child.m_Biases.N() != parent1.m_Biases.N() || child.m_Biases.M() != parent1.m_Biases.M())
+		child.m_Biases = Matrix<float>(parent1.m_Biases.N(), parent1.m_Biases.M(), Uninitialized);
+
+	child.m_Function = parent1.m_Function;
+	child.m_Derivative = parent1.m_Derivative;
+	child.m_FunctionName = parent1.m_FunctionName;
+	child.m_Activation = parent1.m_Activation;
 
 	Mix(child.m_Weights, parent1.m_Weights, parent2.m_Weights);
 	Mix(child.m_Biases, parent1.m_Biases, parent2.m_Biases);
-
-	return child;
 }
 
 Layer Layer::MutateLayer(const Layer& layer, float chance, float range) {
-	assert(layer.IsComplete());
+	Layer mutated;
+	MutateLayer(layer, chance, range, mutated);
+	return mutated;
+}
 
-    Layer mutatedLayer(layer);
+void Layer::MutateLayer(const Layer& layer, float chance, float range, Layer& mutated) {
+	assert(layer.IsComplete());
 
-	auto mutator = [=](float &e) {
-        if (GetRandom<float>(0, 1) < chance) {
-            e += GetRandom<float>(-range, range); // Adjust mutation strength as needed
-        }
-    };
-    
-    mutatedLayer.m_Weights.ForEach(mutator);
-    mutatedLayer.m_Biases.ForEach(mutator);
+	//copy assignment keeps storage of matrices with the same shape
+	if(&mutated != &layer)
+		mutated = layer;
 
-    return mutatedLayer;
+	Mutate(mutated.m_Weights, chance, range);
+	Mutate(mutated.m_Biases, chance, range);
 }
 
 
@@ -144,104 +285,190 @@ Matrix<float> NeuralNetwork::Do(Matrix<float> Input)const{
 	return Input;
 }
 
-float ComputeMeanSquaredError(const Matrix<float>& prediction, const Matrix<float>& target) {
-    Matrix<float> diff = prediction - target;
-    float mse = 0.0f;
-    size_t count = diff.Count();
-    for (size_t i = 0; i < count; ++i) {
-        mse += diff.Data()[i] * diff.Data()[i];
-    }
-    return mse / static_cast<float>(count);
+const float *NeuralNetwork::Do(const float *input, InferenceWorkspace &workspace)const {
+	workspace.Reserve(m_Topology);
+
+	for (std::size_t i = 0; i < m_Model.size(); i++) {
+		float *output = workspace.Buffer(i);
+
+		m_Model[i].Do(input, output, m_FastMath);
+		input = output;
+	}
+
+	return input;
+}
+
+void NeuralNetwork::Do(const Matrix<float> &input, Matrix<float> &output, InferenceWorkspace &workspace)const {
+	assert(input.N() == 1 && m_Model.size() && input.M() == m_Model.front().Weights().N());
+
+	const std::size_t outputs = m_Model.back().Weights().M();
+
+	if(output.N() != 1 || output.M() != outputs)
+		output = Matrix<float>(1, outputs);
+
+	const float *result = Do(input.Data(), workspace);
+	std::copy(result, result + outputs, output.Data());
 }
 
 Matrix<float> NeuralNetwork::MeanSquaredErrorDerivative(const Matrix<float>& prediction, const Matrix<float>& target) {
-    Matrix<float> result = prediction - target;
-    result.ForEach([](float& val) { val *= 2.0f; });
-    return result;
-}
-
-float NumericalDerivative(ActivationFunction::Ptr func, float x) {
-    const float epsilon = 1e-5;
-    return (func(x + epsilon) - func(x - epsilon)) / (2.0f * epsilon);
-}
-
-
-Matrix<float> ActivationFunctionDerivative(ActivationFunction::Ptr func, const Matrix<float>& mat) {
-    Matrix<float> result(mat.N(), mat.M());
-    for (size_t i = 0; i < mat.N(); ++i) {
-        for (size_t j = 0; j < mat.M(); ++j) {
-            result[i][j] = NumericalDerivative(func, mat[i][j]);
-        }
-    }
-    return result;
-}
-
-float NeuralNetwork::Backpropagation(const std::vector<std::pair<Matrix<float>, Matrix<float>>>& dataset, float learning_rate) {
-    float totalError = 0.0f;
-    
-    for (const auto& data : dataset) {
-        Matrix<float> input = data.first;
-        Matrix<float> target = data.second;
-
-        // Forward pass
-        std::vector<Matrix<float>> layer_inputs;
-        std::vector<Matrix<float>> layer_outputs = { input };
-        
-        for (const auto& layer : m_Model) {
-            input = layer.Do(input);
-            layer_inputs.push_back(input);
-            layer_outputs.push_back(input);
-        }
-
-        Matrix<float> output = layer_outputs.back();
-        totalError += ComputeMeanSquaredError(output, target);
-
-        // Backward pass
-        Matrix<float> error = MeanSquaredErrorDerivative(output, target);
-        
-        for (int i = m_Model.size() - 1; i >= 0; --i) {
-            const Matrix<float>& layer_output = layer_outputs[i + 1];
-            const Matrix<float>& layer_input = layer_outputs[i];
-            Layer& layer = m_Model[i];
-
-            // Compute gradients
-            Matrix<float> output_derivative = ActivationFunctionDerivative(layer.Function(), layer_output);
-            Matrix<float> delta = error * output_derivative.Transpose(); // Element-wise multiplication
-            Matrix<float> weight_gradient = layer_input.Transpose() * delta;
-            Matrix<float> bias_gradient = delta;  // Biases are typically vectors, directly summing the delta values
-
-            // Update weights and biases
-            layer.Weights() = layer.Weights() - (weight_gradient * learning_rate);
-            layer.Biases() = layer.Biases() - (bias_gradient.Transpose() * learning_rate);
-            
-            // Compute error for next layer if not the first layer
-            if (i > 0) {
-                error = delta * layer.Weights().Transpose();
-            }
-        }
-    }
-    
-    return totalError / dataset.size();
+    return (prediction - target) * 2.0f;
 }
 
-NeuralNetwork NeuralNetwork::Crossover(const NeuralNetwork& parent1, const NeuralNetwork& parent2) {
-	NeuralNetwork child(parent1.m_Topology, parent1.m_Functions); // Create a child network with the same topology and functions
+float NeuralNetwork::Backpropagation(const std::vector<std::pair<Matrix<float>, Matrix<float>>>& dataset, float learning_rate, std::size_t batch_size) {
+	if(!dataset.size())
+		return 0.f;
 
-	for (size_t i = 0; i < parent1.m_Model.size(); ++i) {
-		child.m_Model[i] = Layer::Crossover(parent1.m_Model[i], parent2.m_Model[i]);
+	batch_size = std::max<std::size_t>(batch_size, 1);
+
+	TrainingWorkspace &workspace = TrainingWorkspace::ThisThread();
+	float total_error = 0.f;
+
+	for (std::size_t begin = 0; begin < dataset.size(); begin += batch_size) {
+		const std::size_t count = std::min(batch_size, dataset.size() - begin);
+
+		total_error += ComputeGradients(dataset.data() + begin, count, workspace);
+
+		ApplyGradients(workspace, learning_rate / count);
+	}
+
+	return total_error / dataset.size();
+}
+
+float NeuralNetwork::ComputeGradients(const std::pair<Matrix<float>, Matrix<float>> *samples, std::size_t count, TrainingWorkspace &workspace)const {
+	assert(m_Model.size());
+
+	workspace.Reserve(m_Topology, count);
+
+	const std::size_t inputs = m_Model.front().Weights().N();
+	const std::size_t outputs = m_Model.back().Weights().M();
+
+	float *input = workspace.m_Activations.front().data();
+	for (std::size_t r = 0; r < count; r++) {
+		assert(samples[r].first.Count() == inputs);
+		std::copy(samples[r].first.Data(), samples[r].first.Data() + inputs, input + r * inputs);
+	}
+
+	// Forward pass, whole batch goes through each layer as one matrix product
+	for (std::size_t l = 0; l < m_Model.size(); l++) {
+		const Layer &layer = m_Model[l];
+		const std::size_t k = layer.Weights().N();
+		const std::size_t m = layer.Weights().M();
+
+		float *pre_activation = workspace.m_PreActivations[l].data();
+		float *output = workspace.m_Activations[l + 1].data();
+
+		MatrixKernels::Gemm(workspace.m_Activations[l].data(), layer.Weights().Data(), pre_activation, count, k, m);
+		std::copy(pre_activation, pre_activation + count * m, output);
+
+		for (std::size_t r = 0; r < count; r++)
+			ActivationKernels::BiasActivate(layer.Kind(), false, layer.Function(), output + r * m, layer.Biases().Data(), m);
+	}
+
+	// Loss, delta is d(loss)/d(output) of the last layer
+	const float *prediction = workspace.m_Activations.back().data();
+	float *loss_delta = workspace.m_Deltas[0].data();
+	float total_error = 0.f;
+
+	for (std::size_t r = 0; r < count; r++) {
+		assert(samples[r].second.Count() == outputs);
+		const float *target = samples[r].second.Data();
+
+		float error = 0.f;
+		for (std::size_t j = 0; j < outputs; j++) {
+			float difference = prediction[r * outputs + j] - target[j];
+			error += difference * difference;
+			loss_delta[r * outputs + j] = 2.f * difference / outputs;
+		}
+		total_error += error / outputs;
 	}
 
+	// Backward pass
+	for (std::size_t l = m_Model.size(); l-- > 0;) {
+		const Layer &layer = m_Model[l];
+		const std::size_t k = layer.Weights().N();
+		const std::size_t m = layer.Weights().M();
+
+		float *delta = workspace.m_Deltas[(m_Model.size() - 1 - l) & 1].data();
+		float *next_delta = workspace.m_Deltas[(m_Model.size() - l) & 1].data();
+
+		// d(loss)/d(pre activation)
+		if (layer.Kind() == Activation::Custom) {
+			const float *pre_activation = workspace.m_PreActivations[l].data();
+
+			for (std::size_t r = 0; r < count; r++)
+				for (std::size_t j = 0; j < m; j++)
+					delta[r * m + j] *= layer.Derivative()(pre_activation[r * m + j] - layer.Biases().Data()[j]);
+		} else {
+			ActivationKernels::MultiplyDerivative(layer.Kind(), workspace.m_Activations[l + 1].data(), delta, count * m);
+		}
+
+		MatrixKernels::GemmTransposedA(workspace.m_Activations[l].data(), delta, workspace.m_WeightsGradients[l].data(), count, k, m);
+
+		// biases are subtracted in forward pass
+		float *biases_gradient = workspace.m_BiasesGradients[l].data();
+		std::fill(biases_gradient, biases_gradient + m, 0.f);
+		for (std::size_t r = 0; r < count; r++)
+			MatrixKernels::Axpy(-1.f, delta + r * m, biases_gradient, m);
+
+		if (l > 0)
+			MatrixKernels::GemmTransposedB(delta, layer.Weights().Data(), next_delta, count, m, k);
+	}
+
+	return total_error;
+}
+
+void NeuralNetwork::ApplyGradients(const TrainingWorkspace& workspace, float scale) {
+	assert(workspace.LayersCount() == m_Model.size());
+
+	for (std::size_t l = 0; l < m_Model.size(); l++) {
+		Layer &layer = m_Model[l];
+
+		MatrixKernels::Axpy(-scale, workspace.WeightsGradient(l).data(), layer.Weights().Data(), layer.Weights().Count());
+		MatrixKernels::Axpy(-scale, workspace.BiasesGradient(l).data(), layer.Biases().Data(), layer.Biases().Count());
+	}
+}
+
+void NeuralNetwork::Randomize() {
+	for (Layer &layer : m_Model) {
+		layer.Randomize();
+	}
+}
+
+NeuralNetwork NeuralNetwork::Crossover(const NeuralNetwork& parent1, const NeuralNetwork& parent2) {
+	NeuralNetwork child;
+	Crossover(parent1, parent2, child);
 	return child;
 }
 
+void NeuralNetwork::Crossover(const NeuralNetwork& parent1, const NeuralNetwork& parent2, NeuralNetwork& child) {
+	assert(parent1.m_Model.size() == parent2.m_Model.size());
+
+	if (&child != &parent1) {
+		child.m_Topology = parent1.m_Topology;
+		child.m_Functions = parent1.m_Functions;
+		child.m_FastMath = parent1.m_FastMath;
+		child.m_Model.resize(parent1.m_Model.size());
+	}
+
+	for (size_t i = 0; i < parent1.m_Model.size(); ++i) {
+		Layer::Crossover(parent1.m_Model[i], parent2.m_Model[i], child.m_Model[i]);
+	}
+}
+
 NeuralNetwork NeuralNetwork::MutateNetwork(const NeuralNetwork& network, float chance, float range) {
-    NeuralNetwork mutatedNetwork(network);
+	NeuralNetwork mutated;
+	MutateNetwork(network, chance, range, mutated);
+	return mutated;
+}
 
-    for (auto& layer : mutatedNetwork.m_Model) {
-        layer = Layer::MutateLayer(layer, chance, range);
-    }
+void NeuralNetwork::MutateNetwork(const NeuralNetwork& network, float chance, float range, NeuralNetwork& mutated) {
+	//copy assignment reuses storage of every layer
+	if(&mutated != &network)
+		mutated = network;
 
-    return mutatedNetwork;
+	for (auto& layer : mutated.m_Model) {
+		Layer::MutateLayer(layer, chance, range, layer);
+	}
 }
 
 const std::vector<Layer>& NeuralNetwork::Layers()const {
@@ -3,22 +3,94 @@
 #include <map>
 #include <string>
 #include "matrix.hpp"
+#include "activation_kernels.hpp"
 
 namespace ActivationFunction{
 	using Ptr = float (*)(float);
 
 	ActivationFunction::Ptr Find(const std::string& name);
 
+	//names coming from files should be checked before Find
+	bool Exists(const std::string& name);
+
     ActivationFunction::Ptr FindDerivative(const std::string& name);
+
+	//functions with dedicated kernels, Custom for the rest
+	Activation FindKind(const std::string& name);
 }
 
+//Two ping-pong buffers for the widest layer, a forward pass writes each layer into the other one
+class InferenceWorkspace {
+	std::vector<float> m_Buffers[2];
+public:
+	InferenceWorkspace() = default;
+
+	InferenceWorkspace(const std::vector<int> &topology);
+
+	//grows only, does nothing once buffers are big enough for the topology
+	void Reserve(const std::vector<int> &topology);
+
+	float *Buffer(std::size_t index){ return m_Buffers[index & 1].data(); }
+
+	std::size_t Capacity()const{ return m_Buffers[0].size(); }
+
+	//reused by every network running on the calling thread
+	static InferenceWorkspace &ThisThread();
+};
+
+//Per layer buffers of a mini-batch forward and backward pass, rows are samples of the batch
+class TrainingWorkspace {
+	std::size_t m_Batch = 0;
+	std::vector<int> m_Topology;
+
+	//input of every layer and output of the last one
+	std::vector<std::vector<float>> m_Activations;
+	//before bias and activation, read only for layers without analytic derivative
+	std::vector<std::vector<float>> m_PreActivations;
+	std::vector<float> m_Deltas[2];
+
+	std::vector<std::vector<float>> m_WeightsGradients;
+	std::vector<std::vector<float>> m_BiasesGradients;
+
+	friend class NeuralNetwork;
+public:
+	TrainingWorkspace() = default;
+
+	TrainingWorkspace(const std::vector<int> &topology, std::size_t batch);
+
+	//grows only, does nothing once buffers are big enough
+	void Reserve(const std::vector<int> &topology, std::size_t batch);
+
+	std::size_t Batch()const{ return m_Batch; }
+
+	//gradients of the summed loss of the last ComputeGradients call, same shape as layer weights and biases
+	std::vector<float> &WeightsGradient(std::size_t layer){ return m_WeightsGradients[layer]; }
+
+	std::vector<float> &BiasesGradient(std::size_t layer){ return m_BiasesGradients[layer]; }
+
+	const std::vector<float> &WeightsGradient(std::size_t layer)const{ return m_WeightsGradients[layer]; }
+
+	const std::vector<float> &BiasesGradient(std::size_t layer)const{ return m_BiasesGradients[layer]; }
+
+	std::size_t LayersCount()const{ return m_WeightsGradients.size(); }
+
+	static TrainingWorkspace &ThisThread();
+};
+
 class Layer {
 	Matrix<float> m_Weights;
 	Matrix<float> m_Biases;
 	
-	ActivationFunction::Ptr m_Function;
+	ActivationFunction::Ptr m_Function = nullptr;
+	ActivationFunction::Ptr m_Derivative = nullptr;
 	std::string m_FunctionName;
+	Activation m_Activation = Activation::Custom;
 public:
+	//weights and biases of new layers are uniform in [-InitialRange, InitialRange)
+	static constexpr float InitialRange = 20.f;
+
+	Layer() = default;
+
 	Layer(Layer &&layer) = default;
 	Layer(const Layer &layer) = default;
 
@@ -31,6 +103,9 @@ public:
 
 	Matrix<float> Do(const Matrix<float>& input)const;
 
+	//input has Weights().N() elements, output receives Weights().M() of them
+	void Do(const float *input, float *output, bool fast_math = false)const;
+
 	const Matrix<float>& Weights()const;
 
 	const Matrix<float>& Biases()const;
@@ -43,19 +118,37 @@ public:
 
 	ActivationFunction::Ptr Function()const;
 
+	ActivationFunction::Ptr Derivative()const{ return m_Derivative; }
+
+	Activation Kind()const{ return m_Activation; }
+
 	bool IsComplete()const;
 
 	static void Mix(Matrix<float>& output, const Matrix<float>& left, const Matrix<float>& right, float rate = 0.5f);
 
+	//adds uniform noise in [-range, range) to elements picked with chance
+	static void Mutate(Matrix<float>& matrix, float chance, float range);
+
+	//new weights and biases of the same shape, in place
+	void Randomize();
+
 	static Layer Crossover(const Layer& parent1, const Layer& parent2);
 
+	//reuses child storage when it already has the right shape, child may be one of the parents
+	static void Crossover(const Layer& parent1, const Layer& parent2, Layer& child);
+
 	static Layer MutateLayer(const Layer& layer, float chance, float range);
+
+	//reuses mutated storage when it already has the right shape, mutated may be the layer itself
+	static void MutateLayer(const Layer& layer, float chance, float range, Layer& mutated);
 };
 
 class NeuralNetwork {
 	std::vector<Layer> m_Model;
 	std::vector<int> m_Topology;
 	std::vector<std::string> m_Functions;
+	//approximated activations, runtime option that is not serialized
+	bool m_FastMath = false;
 public:
 	NeuralNetwork() = default;
 
@@ -71,16 +164,42 @@ public:
 
 	Matrix<float> Do(Matrix<float> Input)const;
 
-    float Backpropagation(const std::vector<std::pair<Matrix<float>, Matrix<float>>>& dataset, float learning_rate);
+	//no heap allocations once workspace is reserved, returned pointer is valid until next call with this workspace
+	const float *Do(const float *input, InferenceWorkspace &workspace)const;
+
+	//output is reallocated only when its shape is wrong
+	void Do(const Matrix<float> &input, Matrix<float> &output, InferenceWorkspace &workspace = InferenceWorkspace::ThisThread())const;
+
+	//mini-batch gradient descent over dataset in order, returns mean squared error before the updates
+    float Backpropagation(const std::vector<std::pair<Matrix<float>, Matrix<float>>>& dataset, float learning_rate, std::size_t batch_size = 1);
+
+	//gradients of loss summed over count samples are written into workspace, returns summed mean squared error
+	float ComputeGradients(const std::pair<Matrix<float>, Matrix<float>> *samples, std::size_t count, TrainingWorkspace &workspace)const;
+
+	//parameters -= scale * gradients
+	void ApplyGradients(const TrainingWorkspace &workspace, float scale);
 
     Matrix<float> MeanSquaredErrorDerivative(const Matrix<float>& prediction, const Matrix<float>& target);
     
+	//new weights and biases for the same topology, in place
+	void Randomize();
+
 	static NeuralNetwork Crossover(const NeuralNetwork& parent1, const NeuralNetwork& parent2);
 
+	//no heap allocations when child already has the topology of parent1, child may be one of the parents
+	static void Crossover(const NeuralNetwork& parent1, const NeuralNetwork& parent2, NeuralNetwork& child);
+
 	static NeuralNetwork MutateNetwork(const NeuralNetwork& network, float chance, float range);
 
+	//no heap allocations when mutated already has the topology of network, mutated may be the network itself
+	static void MutateNetwork(const NeuralNetwork& network, float chance, float range, NeuralNetwork& mutated);
+
 	const std::vector<Layer>& Layers()const;
 
+	void SetFastMath(bool fast_math){ m_FastMath = fast_math; }
+
+	bool FastMath()const{ return m_FastMath; }
+
 	const std::vector<int>& Topology()const;
 
 	const std::vector<std::string>& Functions()const;
@@ -0,0 +1,130 @@
+#include "nn_population.hpp"
+#include <algorithm>
+#include "matrix_kernels.hpp"
+
+PopulationNetwork::PopulationNetwork(const std::vector<const NeuralNetwork*>& networks) {
+	Build(networks);
+}
+
+void PopulationNetwork::Build(const std::vector<const NeuralNetwork*>& networks) {
+	m_Count = networks.size();
+	m_Lanes = std::min(GroupLanes, (m_Count + LaneWidth - 1) / LaneWidth * LaneWidth);
+	m_Groups = m_Lanes ? (m_Count + m_Lanes - 1) / m_Lanes : 0;
+	m_Layers.clear();
+	m_GroupParameters = 0;
+	m_Widest = 0;
+
+	if (!m_Count) {
+		m_Parameters.clear();
+		return;
+	}
+
+	const NeuralNetwork &first = *networks.front();
+	m_FastMath = first.FastMath();
+
+	for (const Layer &layer : first.Layers()) {
+		PackedLayer packed;
+		packed.Inputs = layer.Weights().N();
+		packed.Outputs = layer.Weights().M();
+		packed.Weights = m_GroupParameters;
+		packed.Biases = packed.Weights + packed.Inputs * packed.Outputs * m_Lanes;
+		packed.Kind = ActivationFunction::FindKind(layer.FunctionName());
+		packed.Function = layer.Function();
+
+		m_GroupParameters = packed.Biases + packed.Outputs * m_Lanes;
+		m_Widest = std::max(m_Widest, packed.Outputs);
+
+		m_Layers.push_back(packed);
+	}
+
+	m_Parameters.assign(m_GroupParameters * m_Groups, 0.f);
+
+	for (std::size_t slot = 0; slot < m_Count; slot++) {
+		const NeuralNetwork &network = *networks[slot];
+		assert(IsCompatible(first, network));
+
+		float *group = m_Parameters.data() + slot / m_Lanes * m_GroupParameters;
+		const std::size_t lane = slot % m_Lanes;
+
+		for (std::size_t l = 0; l < m_Layers.size(); l++) {
+			const PackedLayer &packed = m_Layers[l];
+			const float *weights = network.Layers()[l].Weights().Data();
+			const float *biases = network.Layers()[l].Biases().Data();
+
+			for (std::size_t i = 0; i < packed.Inputs * packed.Outputs; i++)
+				group[packed.Weights + i * m_Lanes + lane] = weights[i];
+
+			for (std::size_t j = 0; j < packed.Outputs; j++)
+				group[packed.Biases + j * m_Lanes + lane] = biases[j];
+		}
+	}
+
+	m_Input.assign(Inputs() * m_Lanes * m_Groups, 0.f);
+	m_Output.assign(Outputs() * m_Lanes * m_Groups, 0.f);
+
+	for (auto &buffer : m_Buffers) {
+		buffer.resize(m_Widest * m_Lanes);
+	}
+}
+
+void PopulationNetwork::SetInput(std::size_t slot, const float* input) {
+	assert(slot < m_Count);
+
+	for (std::size_t i = 0; i < Inputs(); i++)
+		m_Input[Index(slot, i, Inputs())] = input[i];
+}
+
+void PopulationNetwork::Do() {
+	for (std::size_t g = 0; g < m_Groups; g++) {
+		DoGroup(g, m_Buffers[0].data(), m_Buffers[1].data());
+	}
+}
+
+void PopulationNetwork::Do(WorkerPool& pool) {
+	m_WorkerBuffers.resize(pool.Size() * 2);
+	for (auto &buffer : m_WorkerBuffers) {
+		buffer.resize(m_Widest * m_Lanes);
+	}
+
+	pool.ParallelFor(m_Groups, [&](std::size_t g, std::size_t worker) {
+		DoGroup(g, m_WorkerBuffers[worker * 2].data(), m_WorkerBuffers[worker * 2 + 1].data());
+	});
+}
+
+void PopulationNetwork::DoGroup(std::size_t group, float* buffer0, float* buffer1) {
+	const float *parameters = m_Parameters.data() + group * m_GroupParameters;
+	const float *input = m_Input.data() + group * Inputs() * m_Lanes;
+	float *buffers[2] = {buffer0, buffer1};
+
+	for (std::size_t l = 0; l < m_Layers.size(); l++) {
+		const PackedLayer &packed = m_Layers[l];
+		const bool last = l + 1 == m_Layers.size();
+		//output of a group is written by its worker only
+		float *output = last ? m_Output.data() + group * Outputs() * m_Lanes : buffers[l & 1];
+
+		MatrixKernels::BatchedGemv(input, parameters + packed.Weights, output, packed.Inputs, packed.Outputs, m_Lanes);
+
+		//biases are interleaved the same way, so lanes are just more elements
+		ActivationKernels::BiasActivate(packed.Kind, m_FastMath, packed.Function, output, parameters + packed.Biases, packed.Outputs * m_Lanes);
+
+		input = output;
+	}
+}
+
+bool PopulationNetwork::IsCompatible(const NeuralNetwork& left, const NeuralNetwork& right) {
+	if(left.Layers().size() != right.Layers().size() || left.FastMath() != right.FastMath())
+		return false;
+
+	for (std::size_t l = 0; l < left.Layers().size(); l++) {
+		const Layer &a = left.Layers()[l];
+		const Layer &b = right.Layers()[l];
+
+		if(a.Weights().N() != b.Weights().N() || a.Weights().M() != b.Weights().M() || a.FunctionName() != b.FunctionName())
+			return false;
+
+		if(a.Biases().Count() != b.Biases().Count())
+			return false;
+	}
+
+	return true;
+}
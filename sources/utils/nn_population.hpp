@@ -0,0 +1,83 @@
+#pragma once
+
+#include <vector>
+#include "nn.hpp"
+#include "worker_pool.hpp"
+
+//Weights of many networks with the same topology packed into one buffer, interleaved across networks
+//in groups of GroupLanes, so forward pass runs SIMD lanes across networks and a whole group stays in cache.
+//Every network gets bit exact output of NeuralNetwork::Do in the same math mode
+class PopulationNetwork {
+	struct PackedLayer {
+		std::size_t Inputs = 0;
+		std::size_t Outputs = 0;
+		std::size_t Weights = 0;
+		std::size_t Biases = 0;
+		Activation Kind = Activation::Custom;
+		ActivationFunction::Ptr Function = nullptr;
+	};
+
+	std::size_t m_Count = 0;
+	std::size_t m_Lanes = 0;
+	std::size_t m_Groups = 0;
+	//offsets within a group are for m_Lanes interleaved networks
+	std::vector<PackedLayer> m_Layers;
+	std::size_t m_GroupParameters = 0;
+	std::vector<float> m_Parameters;
+	//outputs of the widest layer
+	std::size_t m_Widest = 0;
+
+	std::vector<float> m_Input;
+	std::vector<float> m_Output;
+	std::vector<float> m_Buffers[2];
+	//two hidden buffers per worker of the last pool, groups are independent
+	std::vector<std::vector<float>> m_WorkerBuffers;
+
+	bool m_FastMath = false;
+public:
+	//lanes are padded to SIMD width, padding networks have zero weights
+	static constexpr std::size_t LaneWidth = 4;
+	//weights of a group for the agent topology are under 300KB
+	static constexpr std::size_t GroupLanes = 64;
+
+	PopulationNetwork() = default;
+
+	PopulationNetwork(const std::vector<const NeuralNetwork*> &networks);
+
+	//networks should be compatible with the first one, slot of each is its index, storage is reused between builds.
+	//Math mode is taken from the first network
+	void Build(const std::vector<const NeuralNetwork*> &networks);
+
+	//input has Inputs() elements
+	void SetInput(std::size_t slot, const float *input);
+
+	//runs every packed network on its last input
+	void Do();
+
+	//same with groups spread over workers, results are the same
+	void Do(WorkerPool &pool);
+
+	//valid after Do
+	float Output(std::size_t slot, std::size_t index)const{ return m_Output[Index(slot, index, Outputs())]; }
+
+	std::size_t Count()const{ return m_Count; }
+
+	std::size_t Inputs()const{ return m_Layers.size() ? m_Layers.front().Inputs : 0; }
+
+	std::size_t Outputs()const{ return m_Layers.size() ? m_Layers.back().Outputs : 0; }
+
+	void SetFastMath(bool fast_math){ m_FastMath = fast_math; }
+
+	bool FastMath()const{ return m_FastMath; }
+
+	//same layers shapes, activation functions and math mode
+	static bool IsCompatible(const NeuralNetwork &left, const NeuralNetwork &right);
+
+private:
+	void DoGroup(std::size_t group, float *buffer0, float *buffer1);
+
+	//element of network in a buffer holding size elements per network
+	std::size_t Index(std::size_t slot, std::size_t element, std::size_t size)const{
+		return (slot / m_Lanes) * size * m_Lanes + element * m_Lanes + slot % m_Lanes;
+	}
+};
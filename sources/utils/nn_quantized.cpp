@@ -0,0 +1,241 @@
+#include "nn_quantized.hpp"
+#include <cmath>
+#include <chrono>
+#include <limits>
+#include <algorithm>
+#include "matrix_kernels.hpp"
+
+static constexpr float QuantizedMax = 127.f;
+
+//rounds half to even like cvtps2dq, so both paths agree
+static std::int32_t QuantizeInput(float value, float inverse_scale) {
+	return std::int32_t(std::nearbyint(std::clamp(value * inverse_scale, -QuantizedMax, QuantizedMax)));
+}
+
+//packs input into int16 pairs for MatrixKernels::GemvInt16, odd tail is paired with zero
+static void QuantizeInputs(const float *input, std::size_t count, float inverse_scale, std::int32_t *pairs) {
+	std::size_t i = 0;
+#if MATRIX_KERNELS_SSE
+	const __m128 scale = _mm_set1_ps(inverse_scale);
+	const __m128 low = _mm_set1_ps(-QuantizedMax);
+	const __m128 high = _mm_set1_ps(QuantizedMax);
+
+	for (; i + 8 <= count; i += 8) {
+		__m128i first = _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(input + i), scale), low), high));
+		__m128i second = _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(input + i + 4), scale), low), high));
+
+		//int16 halves land in the pair layout directly
+		_mm_storeu_si128((__m128i*)(pairs + i / 2), _mm_packs_epi32(first, second));
+	}
+#endif
+	for (; i < count; i += 2) {
+		std::int32_t first = QuantizeInput(input[i], inverse_scale);
+		std::int32_t second = i + 1 < count ? QuantizeInput(input[i + 1], inverse_scale) : 0;
+
+		pairs[i / 2] = std::int32_t((std::uint32_t(std::uint16_t(second)) << 16) | std::uint16_t(first));
+	}
+}
+
+static float SymmetricScale(float range) {
+	return range > 0.f && std::isfinite(range) ? range / QuantizedMax : 1.f;
+}
+
+void QuantizedWorkspace::Reserve(std::size_t widest) {
+	if(m_Accumulators.size() >= widest + 4)
+		return;
+
+	//outputs are computed in blocks of 4
+	m_Pairs.resize(widest / 2 + 1);
+	m_Accumulators.resize(widest + 4);
+	for (auto &buffer : m_Buffers) {
+		buffer.resize(widest);
+	}
+}
+
+QuantizedWorkspace& QuantizedWorkspace::ThisThread() {
+	static thread_local QuantizedWorkspace workspace;
+	return workspace;
+}
+
+QuantizedLayer::QuantizedLayer(const Layer& layer, float input_range):
+	m_Inputs(layer.Weights().N()),
+	m_Outputs(layer.Weights().M()),
+	m_InputScale(SymmetricScale(input_range)),
+	m_FunctionName(layer.FunctionName())
+{
+	const float *weights = layer.Weights().Data();
+	const float *biases = layer.Biases().Data();
+
+	m_WeightsScales.resize(m_Outputs);
+	for (std::size_t j = 0; j < m_Outputs; j++) {
+		float range = 0.f;
+		for (std::size_t i = 0; i < m_Inputs; i++)
+			range = std::max(range, std::abs(weights[i * m_Outputs + j]));
+
+		m_WeightsScales[j] = SymmetricScale(range);
+	}
+
+	m_Weights.assign(Blocks() * Pairs() * 8, 0);
+	for (std::size_t i = 0; i < m_Inputs; i++) {
+		for (std::size_t j = 0; j < m_Outputs; j++) {
+			float scaled = std::round(weights[i * m_Outputs + j] / m_WeightsScales[j]);
+
+			m_Weights[((j / 4) * Pairs() + i / 2) * 8 + (j % 4) * 2 + i % 2] = std::int16_t(std::clamp(scaled, -QuantizedMax, QuantizedMax));
+		}
+	}
+
+	m_Biases.resize(m_Outputs);
+	for (std::size_t j = 0; j < m_Outputs; j++) {
+		double scaled = std::round(double(biases[j]) / (double(m_InputScale) * m_WeightsScales[j]));
+		constexpr double limit = std::numeric_limits<std::int32_t>::max();
+
+		m_Biases[j] = std::int32_t(std::clamp(scaled, -limit, limit));
+	}
+
+	Prepare();
+}
+
+void QuantizedLayer::Do(const float* input, float* output, QuantizedWorkspace& workspace, bool fast_math)const {
+	std::int32_t *pairs = workspace.m_Pairs.data();
+	std::int32_t *accumulators = workspace.m_Accumulators.data();
+
+	QuantizeInputs(input, m_Inputs, 1.f / m_InputScale, pairs);
+
+	MatrixKernels::GemvInt16(pairs, m_Weights.data(), accumulators, Pairs(), m_Outputs);
+
+	for (std::size_t j = 0; j < m_Outputs; j++)
+		output[j] = float(accumulators[j]) * m_OutputScales[j];
+
+	ActivationKernels::BiasActivate(m_Activation, fast_math, m_Function, output, m_DequantizedBiases.data(), m_Outputs);
+}
+
+bool QuantizedLayer::IsComplete()const {
+	return m_Inputs && m_Outputs
+		&& m_Weights.size() == Blocks() * Pairs() * 8
+		&& m_WeightsScales.size() == m_Outputs
+		&& m_Biases.size() == m_Outputs
+		&& m_InputScale > 0.f;
+}
+
+void QuantizedLayer::Prepare() {
+	m_Function = ActivationFunction::Find(m_FunctionName);
+	m_Activation = ActivationFunction::FindKind(m_FunctionName);
+
+	m_OutputScales.resize(m_Outputs);
+	m_DequantizedBiases.resize(m_Outputs);
+
+	for (std::size_t j = 0; j < m_Outputs; j++) {
+		m_OutputScales[j] = m_InputScale * m_WeightsScales[j];
+		m_DequantizedBiases[j] = float(m_Biases[j]) * m_OutputScales[j];
+	}
+}
+
+QuantizedNetwork::QuantizedNetwork(std::vector<QuantizedLayer> layers):
+	m_Layers(std::move(layers))
+{
+	for (const auto &layer : m_Layers)
+		m_Widest = std::max({m_Widest, layer.Inputs(), layer.Outputs()});
+}
+
+const float *QuantizedNetwork::Do(const float* input, QuantizedWorkspace& workspace)const {
+	workspace.Reserve(m_Widest);
+
+	for (std::size_t i = 0; i < m_Layers.size(); i++) {
+		float *output = workspace.m_Buffers[i & 1].data();
+
+		m_Layers[i].Do(input, output, workspace, m_FastMath);
+		input = output;
+	}
+
+	return input;
+}
+
+void QuantizedNetwork::Do(const Matrix<float>& input, Matrix<float>& output, QuantizedWorkspace& workspace)const {
+	assert(input.N() == 1 && m_Layers.size() && input.M() == Inputs());
+
+	if(output.N() != 1 || output.M() != Outputs())
+		output = Matrix<float>(1, Outputs());
+
+	const float *result = Do(input.Data(), workspace);
+	std::copy(result, result + Outputs(), output.Data());
+}
+
+QuantizedNetwork QuantizedNetwork::Quantize(const NeuralNetwork& network, const Dataset& calibration) {
+	const auto &layers = network.Layers();
+	std::vector<float> ranges(layers.size(), 0.f);
+
+	InferenceWorkspace workspace(network.Topology());
+
+	for (const auto &[input, target] : calibration) {
+		const float *data = input.Data();
+
+		for (std::size_t l = 0; l < layers.size(); l++) {
+			for (std::size_t i = 0; i < layers[l].Weights().N(); i++)
+				ranges[l] = std::max(ranges[l], std::abs(data[i]));
+
+			float *output = workspace.Buffer(l);
+			layers[l].Do(data, output, network.FastMath());
+			data = output;
+		}
+	}
+
+	std::vector<QuantizedLayer> quantized;
+	for (std::size_t l = 0; l < layers.size(); l++)
+		quantized.emplace_back(layers[l], ranges[l]);
+
+	QuantizedNetwork result(std::move(quantized));
+	result.SetFastMath(network.FastMath());
+
+	return result;
+}
+
+QuantizationReport QuantizedNetwork::Evaluate(const NeuralNetwork& network, const QuantizedNetwork& quantized, const Dataset& dataset) {
+	QuantizationReport report;
+	report.Samples = dataset.size();
+
+	if(!dataset.size() || network.Layers().empty() || quantized.Outputs() != network.Layers().back().Weights().M())
+		return report;
+
+	const std::size_t outputs = quantized.Outputs();
+	std::vector<float> float_outputs(dataset.size() * outputs);
+	std::vector<float> quantized_outputs(dataset.size() * outputs);
+
+	InferenceWorkspace float_workspace(network.Topology());
+	QuantizedWorkspace quantized_workspace;
+
+	auto begin = std::chrono::steady_clock::now();
+	for (std::size_t s = 0; s < dataset.size(); s++) {
+		const float *result = network.Do(dataset[s].first.Data(), float_workspace);
+		std::copy(result, result + outputs, float_outputs.data() + s * outputs);
+	}
+	report.FloatSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+	begin = std::chrono::steady_clock::now();
+	for (std::size_t s = 0; s < dataset.size(); s++) {
+		const float *result = quantized.Do(dataset[s].first.Data(), quantized_workspace);
+		std::copy(result, result + outputs, quantized_outputs.data() + s * outputs);
+	}
+	report.QuantizedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+	double error_sum = 0, float_loss = 0, quantized_loss = 0;
+	for (std::size_t s = 0; s < dataset.size(); s++) {
+		const float *target = dataset[s].second.Data();
+
+		for (std::size_t j = 0; j < outputs; j++) {
+			float f = float_outputs[s * outputs + j];
+			float q = quantized_outputs[s * outputs + j];
+			float error = std::abs(f - q);
+
+			report.MaxError = std::max(report.MaxError, error);
+			error_sum += error;
+			float_loss += (f - target[j]) * (f - target[j]);
+			quantized_loss += (q - target[j]) * (q - target[j]);
+		}
+	}
+
+	report.MeanError = error_sum / (dataset.size() * outputs);
+	report.FloatLoss = float_loss / (dataset.size() * outputs);
+	report.QuantizedLoss = quantized_loss / (dataset.size() * outputs);
+
+	return report;
+}
@@ -0,0 +1,202 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include "nn.hpp"
+
+//Buffers of a quantized forward pass, grow only like InferenceWorkspace
+class QuantizedWorkspace {
+	std::vector<std::int32_t> m_Pairs;
+	std::vector<std::int32_t> m_Accumulators;
+	std::vector<float> m_Buffers[2];
+
+	friend class QuantizedLayer;
+	friend class QuantizedNetwork;
+public:
+	void Reserve(std::size_t widest);
+
+	static QuantizedWorkspace &ThisThread();
+};
+
+//Post-training int8 layer: per output channel symmetric weight scales, one symmetric scale for its input
+//calibrated on data. Biases are int32 in accumulator units, activations stay float.
+//Weights are int8 in files and kept in memory only widened to int16, half of float size: SSE2 has no int8
+//multiply and sign extending every load costs more than the halved bandwidth saves
+class QuantizedLayer {
+	std::size_t m_Inputs = 0;
+	std::size_t m_Outputs = 0;
+
+	//int8 range, blocked for MatrixKernels::GemvInt16, inputs padded to even and outputs to multiple of 4
+	std::vector<std::int16_t> m_Weights;
+	std::vector<float> m_WeightsScales;
+	std::vector<std::int32_t> m_Biases;
+	float m_InputScale = 1.f;
+
+	std::string m_FunctionName;
+	ActivationFunction::Ptr m_Function = nullptr;
+	Activation m_Activation = Activation::Custom;
+
+	//derived on load: accumulator to float factor per output and biases in float
+	std::vector<float> m_OutputScales;
+	std::vector<float> m_DequantizedBiases;
+
+	friend struct Serializer<QuantizedLayer>;
+public:
+	QuantizedLayer() = default;
+
+	//input_range is max absolute value of layer input seen on calibration data
+	QuantizedLayer(const Layer &layer, float input_range);
+
+	void Do(const float *input, float *output, QuantizedWorkspace &workspace, bool fast_math = false)const;
+
+	std::size_t Inputs()const{ return m_Inputs; }
+
+	std::size_t Outputs()const{ return m_Outputs; }
+
+	float InputScale()const{ return m_InputScale; }
+
+	const std::string &FunctionName()const{ return m_FunctionName; }
+
+	std::size_t Pairs()const{ return (m_Inputs + 1) / 2; }
+
+	std::size_t Blocks()const{ return (m_Outputs + 3) / 4; }
+
+	//true when stored sizes match each other, checked after deserialization
+	bool IsComplete()const;
+
+	//recomputes derived data from stored one
+	void Prepare();
+};
+
+struct QuantizationReport {
+	std::size_t Samples = 0;
+	//float network output against quantized one
+	float MaxError = 0.f;
+	float MeanError = 0.f;
+	//mean squared error against dataset targets
+	float FloatLoss = 0.f;
+	float QuantizedLoss = 0.f;
+
+	double FloatSeconds = 0;
+	double QuantizedSeconds = 0;
+
+	double Speedup()const{ return QuantizedSeconds > 0 ? FloatSeconds / QuantizedSeconds : 0; }
+};
+
+class QuantizedNetwork {
+	std::vector<QuantizedLayer> m_Layers;
+	std::size_t m_Widest = 0;
+	bool m_FastMath = false;
+
+	friend struct Serializer<QuantizedNetwork>;
+public:
+	using Dataset = std::vector<std::pair<Matrix<float>, Matrix<float>>>;
+
+	QuantizedNetwork() = default;
+
+	QuantizedNetwork(std::vector<QuantizedLayer> layers);
+
+	//same contract as NeuralNetwork::Do, returned pointer is valid until next call with this workspace
+	const float *Do(const float *input, QuantizedWorkspace &workspace = QuantizedWorkspace::ThisThread())const;
+
+	void Do(const Matrix<float> &input, Matrix<float> &output, QuantizedWorkspace &workspace = QuantizedWorkspace::ThisThread())const;
+
+	const std::vector<QuantizedLayer> &Layers()const{ return m_Layers; }
+
+	std::size_t Inputs()const{ return m_Layers.size() ? m_Layers.front().Inputs() : 0; }
+
+	std::size_t Outputs()const{ return m_Layers.size() ? m_Layers.back().Outputs() : 0; }
+
+	void SetFastMath(bool fast_math){ m_FastMath = fast_math; }
+
+	bool FastMath()const{ return m_FastMath; }
+
+	//input ranges of every layer are taken from float forward pass over calibration inputs
+	static QuantizedNetwork Quantize(const NeuralNetwork &network, const Dataset &calibration);
+
+	//accuracy and speed of quantized network against the float one on dataset
+	static QuantizationReport Evaluate(const NeuralNetwork &network, const QuantizedNetwork &quantized, const Dataset &dataset);
+};
+
+template<>
+struct Serializer<QuantizedLayer>{
+	static void ToStream(const QuantizedLayer& layer, std::ostream& stream) {
+		Serializer<std::size_t>::ToStream(layer.m_Inputs, stream);
+		Serializer<std::size_t>::ToStream(layer.m_Outputs, stream);
+		Serializer<std::vector<std::int8_t>>::ToStream(std::vector<std::int8_t>(layer.m_Weights.begin(), layer.m_Weights.end()), stream);
+		Serializer<std::vector<float>>::ToStream(layer.m_WeightsScales, stream);
+		Serializer<std::vector<std::int32_t>>::ToStream(layer.m_Biases, stream);
+		Serializer<float>::ToStream(layer.m_InputScale, stream);
+		Serializer<std::string>::ToStream(layer.m_FunctionName, stream);
+	}
+
+	static std::optional<QuantizedLayer> FromStream(std::istream& stream) {
+		auto inputs = Serializer<std::size_t>::FromStream(stream);
+		auto outputs = Serializer<std::size_t>::FromStream(stream);
+		auto weights = Serializer<std::vector<std::int8_t>>::FromStream(stream);
+		auto scales = Serializer<std::vector<float>>::FromStream(stream);
+		auto biases = Serializer<std::vector<std::int32_t>>::FromStream(stream);
+		auto input_scale = Serializer<float>::FromStream(stream);
+		auto function = Serializer<std::string>::FromStream(stream);
+
+		if(!inputs.has_value() || !outputs.has_value() || !weights.has_value() || !scales.has_value() || !biases.has_value() || !input_scale.has_value() || !function.has_value())
+			return std::nullopt;
+
+		QuantizedLayer layer;
+		layer.m_Inputs = inputs.value();
+		layer.m_Outputs = outputs.value();
+		layer.m_Weights.assign(weights->begin(), weights->end());
+		layer.m_WeightsScales = std::move(scales.value());
+		layer.m_Biases = std::move(biases.value());
+		layer.m_InputScale = input_scale.value();
+		layer.m_FunctionName = std::move(function.value());
+
+		if(!layer.IsComplete())
+			return std::nullopt;
+
+		layer.Prepare();
+
+		return {std::move(layer)};
+	}
+};
+
+//tagged and versioned, so float model file given by mistake is rejected.
+//Version 2 adds math mode after layers, version 1 files load with exact math
+template<>
+struct Serializer<QuantizedNetwork>{
+	static constexpr std::uint32_t Magic = 0x38514E44; //"DNQ8"
+	static constexpr std::uint32_t Version = 2;
+
+	static void ToStream(const QuantizedNetwork& network, std::ostream& stream) {
+		Serializer<std::uint32_t>::ToStream(Magic, stream);
+		Serializer<std::uint32_t>::ToStream(Version, stream);
+		Serializer<std::vector<QuantizedLayer>>::ToStream(network.m_Layers, stream);
+		Serializer<std::uint8_t>::ToStream(network.m_FastMath, stream);
+	}
+
+	static std::optional<QuantizedNetwork> FromStream(std::istream& stream) {
+		auto magic = Serializer<std::uint32_t>::FromStream(stream);
+		auto version = Serializer<std::uint32_t>::FromStream(stream);
+
+		if(magic.value_or(0) != Magic || version.value_or(0) < 1 || version.value_or(0) > Version)
+			return std::nullopt;
+
+		auto layers = Serializer<std::vector<QuantizedLayer>>::FromStream(stream);
+
+		if(!layers.has_value())
+			return std::nullopt;
+
+		QuantizedNetwork network(std::move(layers.value()));
+
+		if (version.value() >= 2) {
+			auto fast_math = Serializer<std::uint8_t>::FromStream(stream);
+
+			if(!fast_math.has_value())
+				return std::nullopt;
+
+			network.SetFastMath(fast_math.value());
+		}
+
+		return {std::move(network)};
+	}
+};
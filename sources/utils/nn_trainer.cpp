@@ -0,0 +1,85 @@
+#include "nn_trainer.hpp"
+#include <chrono>
+#include <algorithm>
+#include "matrix_kernels.hpp"
+
+ParallelTrainer::ParallelTrainer(std::size_t threads, std::size_t batch_size, std::size_t chunk_size):
+	m_Pool(threads),
+	m_BatchSize(std::max<std::size_t>(batch_size, 1)),
+	m_ChunkSize(std::clamp<std::size_t>(chunk_size, 1, m_BatchSize))
+{
+	m_Chunks.resize((m_BatchSize + m_ChunkSize - 1) / m_ChunkSize);
+	m_ChunkErrors.resize(m_Chunks.size());
+}
+
+TrainingReport ParallelTrainer::Epoch(NeuralNetwork& network, const Dataset& dataset, float learning_rate) {
+	TrainingReport report;
+	report.Samples = dataset.size();
+
+	if(!dataset.size())
+		return report;
+
+	const auto begin = std::chrono::steady_clock::now();
+
+	double total_error = 0;
+	for (std::size_t first = 0; first < dataset.size(); first += m_BatchSize) {
+		const std::size_t count = std::min(m_BatchSize, dataset.size() - first);
+
+		total_error += Batch(network, dataset.data() + first, count, learning_rate);
+	}
+
+	report.Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+	report.Error = total_error / dataset.size();
+
+	return report;
+}
+
+float ParallelTrainer::Batch(NeuralNetwork& network, const std::pair<Matrix<float>, Matrix<float>>* samples, std::size_t count, float learning_rate) {
+	const std::size_t chunks = (count + m_ChunkSize - 1) / m_ChunkSize;
+
+	m_Pool.ParallelFor(chunks, [&](std::size_t chunk, std::size_t worker) {
+		const std::size_t first = chunk * m_ChunkSize;
+		const std::size_t size = std::min(m_ChunkSize, count - first);
+
+		m_ChunkErrors[chunk] = network.ComputeGradients(samples + first, size, m_Chunks[chunk]);
+	});
+
+	//pairs of each level are independent, shape of the tree depends only on chunks count
+	for (std::size_t stride = 1; stride < chunks; stride *= 2) {
+		const std::size_t pairs = (chunks - stride + 2 * stride - 1) / (2 * stride);
+
+		m_Pool.ParallelFor(pairs, [&](std::size_t pair, std::size_t worker) {
+			const std::size_t target = pair * 2 * stride;
+
+			AddGradients(m_Chunks[target], m_Chunks[target + stride]);
+			m_ChunkErrors[target] += m_ChunkErrors[target + stride];
+		});
+	}
+
+	network.ApplyGradients(m_Chunks.front(), learning_rate / count);
+
+	return m_ChunkErrors.front();
+}
+
+void ParallelTrainer::AddGradients(TrainingWorkspace& target, const TrainingWorkspace& source) {
+	for (std::size_t l = 0; l < target.LayersCount(); l++) {
+		MatrixKernels::Axpy(1.f, source.WeightsGradient(l).data(), target.WeightsGradient(l).data(), target.WeightsGradient(l).size());
+		MatrixKernels::Axpy(1.f, source.BiasesGradient(l).data(), target.BiasesGradient(l).data(), target.BiasesGradient(l).size());
+	}
+}
+
+std::vector<Scaling> ParallelTrainer::MeasureScaling(const NeuralNetwork& network, const Dataset& dataset, float learning_rate, std::size_t max_threads, std::size_t batch_size, std::size_t chunk_size) {
+	if(!max_threads)
+		max_threads = WorkerPool::HardwareThreads();
+
+	std::vector<Scaling> scaling;
+
+	for (std::size_t threads = 1; threads <= max_threads; threads *= 2) {
+		NeuralNetwork copy = network;
+		ParallelTrainer trainer(threads, batch_size, chunk_size);
+
+		AppendScaling(scaling, threads, trainer.Epoch(copy, dataset, learning_rate).SamplesPerSecond());
+	}
+
+	return scaling;
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <vector>
+#include "nn.hpp"
+#include "worker_pool.hpp"
+
+struct TrainingReport {
+	std::size_t Samples = 0;
+	double Seconds = 0;
+	//mean squared error before the updates
+	float Error = 0.f;
+
+	double SamplesPerSecond()const{ return Seconds > 0 ? Samples / Seconds : 0; }
+};
+
+//Data parallel mini-batch gradient descent. Every batch is cut into chunks of ChunkSize samples that workers
+//take in any order, each chunk keeps its own gradients. Chunks are summed by a fixed pairwise tree before
+//the update, so trained weights are the same for any number of threads
+class ParallelTrainer {
+	WorkerPool m_Pool;
+	std::size_t m_BatchSize = 0;
+	std::size_t m_ChunkSize = 0;
+
+	//one per chunk of a batch, reused between batches and epochs
+	std::vector<TrainingWorkspace> m_Chunks;
+	std::vector<float> m_ChunkErrors;
+public:
+	using Dataset = std::vector<std::pair<Matrix<float>, Matrix<float>>>;
+
+	//0 threads uses every hardware thread
+	ParallelTrainer(std::size_t threads = 0, std::size_t batch_size = 128, std::size_t chunk_size = 16);
+
+	//one pass over dataset in order
+	TrainingReport Epoch(NeuralNetwork &network, const Dataset &dataset, float learning_rate);
+
+	std::size_t ThreadsCount()const{ return m_Pool.Size(); }
+
+	std::size_t BatchSize()const{ return m_BatchSize; }
+
+	std::size_t ChunkSize()const{ return m_ChunkSize; }
+
+	//trains a copy of network for one epoch with 1, 2, 4 ... max_threads threads, items are samples
+	static std::vector<Scaling> MeasureScaling(const NeuralNetwork &network, const Dataset &dataset, float learning_rate, std::size_t max_threads = 0, std::size_t batch_size = 128, std::size_t chunk_size = 16);
+
+private:
+	float Batch(NeuralNetwork &network, const std::pair<Matrix<float>, Matrix<float>> *samples, std::size_t count, float learning_rate);
+
+	//target gradients += source gradients
+	static void AddGradients(TrainingWorkspace &target, const TrainingWorkspace &source);
+};
@@ -1,15 +1,216 @@
 #pragma once
 
 #include <random>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <cmath>
+#include "matrix_kernels.hpp"
+
+//xoshiro128++ generator. Every instance owns five non overlapping 2^64 long subsequences: one for single
+//values and four interleaved lanes for bulk generation, so bulk output is the same with and without SSE.
+//Generators created with the same seed and stream give the same numbers on any thread
+class RandomGenerator {
+	static constexpr std::size_t Lanes = 4;
+
+	std::uint32_t m_State[4];
+	//word i of lane a is m_Lanes[i * Lanes + a]
+	alignas(16) std::uint32_t m_Lanes[4 * Lanes];
+public:
+	static constexpr std::uint64_t DefaultSeed = 0x5DEECE66D;
+
+	explicit RandomGenerator(std::uint64_t seed = DefaultSeed, std::uint64_t stream = 0) {
+		std::uint64_t mixer = stream;
+		mixer = seed ^ SplitMix64(mixer);
+
+		for (std::uint32_t &word : m_State) {
+			word = std::uint32_t(SplitMix64(mixer) >> 32);
+		}
+		//all zero state never leaves zero
+		if(!(m_State[0] | m_State[1] | m_State[2] | m_State[3]))
+			m_State[0] = 1;
+
+		SetupLanes();
+	}
+
+	std::uint32_t Next() {
+		return Step(m_State);
+	}
+
+	//[0, 1) with 24 bits of randomness
+	float NextFloat() {
+		return ToFloat(Next());
+	}
+
+	float Range(float min, float max) {
+		return min + NextFloat() * (max - min);
+	}
+
+	//[0, bound), bound is not zero
+	std::uint32_t Below(std::uint32_t bound) {
+		return std::uint32_t((std::uint64_t(Next()) * bound) >> 32);
+	}
+
+	//count values in [min, max), four at a time from the lanes
+	void Fill(float *output, std::size_t count, float min, float max) {
+		const float scale = max - min;
+
+		std::size_t i = 0;
+#if MATRIX_KERNELS_SSE
+		__m128i s0 = _mm_load_si128((const __m128i*)(m_Lanes + 0 * Lanes));
+		__m128i s1 = _mm_load_si128((const __m128i*)(m_Lanes + 1 * Lanes));
+		__m128i s2 = _mm_load_si128((const __m128i*)(m_Lanes + 2 * Lanes));
+		__m128i s3 = _mm_load_si128((const __m128i*)(m_Lanes + 3 * Lanes));
+
+		const __m128 to_float = _mm_set1_ps(0x1.0p-24f);
+		const __m128 min_v = _mm_set1_ps(min);
+		const __m128 scale_v = _mm_set1_ps(scale);
+
+		for (; i + Lanes <= count; i += Lanes) {
+			__m128i sum = _mm_add_epi32(s0, s3);
+			__m128i result = _mm_add_epi32(_mm_or_si128(_mm_slli_epi32(sum, 7), _mm_srli_epi32(sum, 25)), s0);
+			__m128i t = _mm_slli_epi32(s1, 9);
+
+			s2 = _mm_xor_si128(s2, s0);
+			s3 = _mm_xor_si128(s3, s1);
+			s1 = _mm_xor_si128(s1, s2);
+			s0 = _mm_xor_si128(s0, s3);
+			s2 = _mm_xor_si128(s2, t);
+			s3 = _mm_or_si128(_mm_slli_epi32(s3, 11), _mm_srli_epi32(s3, 21));
+
+			__m128 uniform = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(result, 8)), to_float);
+			_mm_storeu_ps(output + i, _mm_add_ps(min_v, _mm_mul_ps(uniform, scale_v)));
+		}
+
+		_mm_store_si128((__m128i*)(m_Lanes + 0 * Lanes), s0);
+		_mm_store_si128((__m128i*)(m_Lanes + 1 * Lanes), s1);
+		_mm_store_si128((__m128i*)(m_Lanes + 2 * Lanes), s2);
+		_mm_store_si128((__m128i*)(m_Lanes + 3 * Lanes), s3);
+#endif
+		//tail takes a whole step of every lane and drops the extra values
+		for (; i < count; i += Lanes) {
+			for (std::size_t a = 0; a < Lanes; a++) {
+				std::uint32_t state[4] = {m_Lanes[a], m_Lanes[Lanes + a], m_Lanes[2 * Lanes + a], m_Lanes[3 * Lanes + a]};
+				const std::uint32_t result = Step(state);
+
+				for(std::size_t w = 0; w < 4; w++)
+					m_Lanes[w * Lanes + a] = state[w];
+
+				if(i + a < count)
+					output[i + a] = min + ToFloat(result) * scale;
+			}
+		}
+	}
+
+	//advances by 2^64 values
+	void Jump() {
+		Jump(m_State);
+	}
+
+	//returns generator with the current subsequences and moves this one past them
+	RandomGenerator Split() {
+		RandomGenerator stream = *this;
+
+		for (std::size_t i = 0; i < Lanes + 1; i++)
+			Jump(m_State);
+		SetupLanes();
+
+		return stream;
+	}
+
+	//seed of generators of threads that did not use random yet, calling thread is reseeded as the first one
+	static void SetSeed(std::uint64_t seed) {
+		RandomGenerator &generator = ThisThread();
+
+		GlobalSeed() = seed;
+		ThreadStream() = 0;
+		generator = RandomGenerator(seed, ThreadStream()++);
+	}
+
+	//every thread gets its own stream of the global seed in order of first use
+	static RandomGenerator &ThisThread() {
+		static thread_local RandomGenerator generator(GlobalSeed(), ThreadStream()++);
+		return generator;
+	}
+
+private:
+	void SetupLanes() {
+		std::uint32_t state[4] = {m_State[0], m_State[1], m_State[2], m_State[3]};
+
+		for (std::size_t a = 0; a < Lanes; a++) {
+			Jump(state);
+
+			for(std::size_t w = 0; w < 4; w++)
+				m_Lanes[w * Lanes + a] = state[w];
+		}
+	}
+
+	static std::uint32_t Rotl(std::uint32_t x, int k) {
+		return (x << k) | (x >> (32 - k));
+	}
+
+	static std::uint32_t Step(std::uint32_t (&s)[4]) {
+		const std::uint32_t result = Rotl(s[0] + s[3], 7) + s[0];
+		const std::uint32_t t = s[1] << 9;
+
+		s[2] ^= s[0];
+		s[3] ^= s[1];
+		s[1] ^= s[2];
+		s[0] ^= s[3];
+		s[2] ^= t;
+		s[3] = Rotl(s[3], 11);
+
+		return result;
+	}
+
+	static void Jump(std::uint32_t (&s)[4]) {
+		static constexpr std::uint32_t Polynomial[4] = {0x8764000b, 0xf542d2d3, 0x6fa035c3, 0x77f2db5b};
+
+		std::uint32_t jumped[4] = {};
+		for (std::uint32_t word : Polynomial) {
+			for (int b = 0; b < 32; b++) {
+				if (word & (1u << b)) {
+					for(std::size_t w = 0; w < 4; w++)
+						jumped[w] ^= s[w];
+				}
+				Step(s);
+			}
+		}
+
+		for(std::size_t w = 0; w < 4; w++)
+			s[w] = jumped[w];
+	}
+
+	static float ToFloat(std::uint32_t value) {
+		return float(value >> 8) * 0x1.0p-24f;
+	}
+
+	static std::uint64_t SplitMix64(std::uint64_t &state) {
+		std::uint64_t z = (state += 0x9E3779B97F4A7C15);
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EB;
+		return z ^ (z >> 31);
+	}
+
+	static std::uint64_t &GlobalSeed() {
+		static std::uint64_t seed = DefaultSeed;
+		return seed;
+	}
+
+	static std::atomic<std::uint64_t> &ThreadStream() {
+		static std::atomic<std::uint64_t> stream{0};
+		return stream;
+	}
+};
 
 template<typename Type>
 Type GetRandom(Type min, Type max);
 
 template<>
 inline float GetRandom(float min, float max) {
-	float e = min + (rand() / float(RAND_MAX)) * (max - min);
+	float e = RandomGenerator::ThisThread().Range(min, max);
 
 	assert(!std::isinf(e) && !std::isnan(e));
 
 	return e;
-}
\ No newline at end of file
+}
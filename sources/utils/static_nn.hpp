@@ -0,0 +1,176 @@
+#pragma once
+
+#include <array>
+#include <tuple>
+#include <string>
+#include <utility>
+#include <optional>
+#include <algorithm>
+#include "nn.hpp"
+#include "matrix_kernels.hpp"
+
+//Network with topology fixed at compile time, layers are std::array so every loop has constant bounds
+//and gets unrolled. Same math and serialized format as NeuralNetwork, results are bit exact with it
+template<std::size_t ...Sizes>
+class StaticNetwork {
+	static_assert(sizeof...(Sizes) >= 2, "StaticNetwork needs at least input and output size");
+public:
+	static constexpr std::array<std::size_t, sizeof...(Sizes)> Topology{Sizes...};
+	static constexpr std::size_t LayersCount = sizeof...(Sizes) - 1;
+	static constexpr std::size_t Inputs = Topology.front();
+	static constexpr std::size_t Outputs = Topology.back();
+	static constexpr std::size_t Widest = *std::max_element(Topology.begin() + 1, Topology.end());
+
+	template<std::size_t InputsCount, std::size_t OutputsCount>
+	struct StaticLayer {
+		std::array<float, InputsCount * OutputsCount> Weights{};
+		std::array<float, OutputsCount> Biases{};
+		Activation Kind = Activation::None;
+		ActivationFunction::Ptr Function = nullptr;
+
+		void Do(const float *input, float *output, bool fast_math)const {
+			std::fill(output, output + OutputsCount, 0.f);
+
+			for (std::size_t i = 0; i < InputsCount; i++) {
+				MatrixKernels::Axpy(input[i], Weights.data() + i * OutputsCount, output, OutputsCount);
+			}
+
+			ActivationKernels::BiasActivate(Kind, fast_math, Function, output, Biases.data(), OutputsCount);
+		}
+	};
+private:
+	template<std::size_t ...Indices>
+	static auto MakeLayers(std::index_sequence<Indices...>) -> std::tuple<StaticLayer<Topology[Indices], Topology[Indices + 1]>...>;
+
+	using Layers = decltype(MakeLayers(std::make_index_sequence<LayersCount>()));
+
+	Layers m_Layers;
+	//one per topology entry like in NeuralNetwork, last one is kept only for serialization
+	std::array<std::string, sizeof...(Sizes)> m_Functions;
+	bool m_FastMath = false;
+public:
+	StaticNetwork() = default;
+
+	std::array<float, Outputs> Do(const std::array<float, Inputs> &input)const {
+		std::array<float, Outputs> output;
+		Do(input.data(), output.data());
+		return output;
+	}
+
+	//input has Inputs elements, output receives Outputs of them
+	void Do(const float *input, float *output)const {
+		std::array<float, Widest> buffers[2];
+
+		DoLayers(input, output, buffers, std::make_index_sequence<LayersCount>());
+	}
+
+	template<std::size_t Index>
+	const auto &LayerAt()const{ return std::get<Index>(m_Layers); }
+
+	template<std::size_t Index>
+	auto &LayerAt(){ return std::get<Index>(m_Layers); }
+
+	const std::array<std::string, sizeof...(Sizes)> &Functions()const{ return m_Functions; }
+
+	void SetFastMath(bool fast_math){ m_FastMath = fast_math; }
+
+	bool FastMath()const{ return m_FastMath; }
+
+	NeuralNetwork ToNetwork()const {
+		std::vector<Layer> layers;
+		ToLayers(layers, std::make_index_sequence<LayersCount>());
+
+		NeuralNetwork network(
+			std::move(layers),
+			std::vector<int>(Topology.begin(), Topology.end()),
+			std::vector<std::string>(m_Functions.begin(), m_Functions.end())
+		);
+		network.SetFastMath(m_FastMath);
+
+		return network;
+	}
+
+	//nullopt when topology of the network differs
+	static std::optional<StaticNetwork> FromNetwork(const NeuralNetwork &network) {
+		if(!IsCompatible(network))
+			return std::nullopt;
+
+		StaticNetwork result;
+		result.FromLayers(network.Layers(), std::make_index_sequence<LayersCount>());
+		std::copy(network.Functions().begin(), network.Functions().end(), result.m_Functions.begin());
+		result.m_FastMath = network.FastMath();
+
+		return {std::move(result)};
+	}
+
+	static bool IsCompatible(const NeuralNetwork &network) {
+		if(network.Layers().size() != LayersCount || network.Topology().size() != Topology.size() || network.Functions().size() != Topology.size())
+			return false;
+
+		for (std::size_t i = 0; i < LayersCount; i++) {
+			const Layer &layer = network.Layers()[i];
+
+			if(layer.Weights().N() != Topology[i] || layer.Weights().M() != Topology[i + 1] || layer.Biases().Count() != Topology[i + 1])
+				return false;
+		}
+
+		return true;
+	}
+
+private:
+	template<std::size_t ...Indices>
+	void DoLayers(const float *input, float *output, std::array<float, Widest> (&buffers)[2], std::index_sequence<Indices...>)const {
+		//last layer writes straight into output
+		((std::get<Indices>(m_Layers).Do(
+			Indices == 0 ? input : buffers[(Indices - 1) & 1].data(),
+			Indices + 1 == LayersCount ? output : buffers[Indices & 1].data(),
+			m_FastMath
+		)), ...);
+	}
+
+	template<std::size_t ...Indices>
+	void ToLayers(std::vector<Layer> &layers, std::index_sequence<Indices...>)const {
+		(layers.push_back(ToLayer(std::get<Indices>(m_Layers), Indices)), ...);
+	}
+
+	template<std::size_t InputsCount, std::size_t OutputsCount>
+	Layer ToLayer(const StaticLayer<InputsCount, OutputsCount> &layer, std::size_t index)const {
+		Matrix<float> weights(InputsCount, OutputsCount);
+		Matrix<float> biases(1, OutputsCount);
+
+		std::copy(layer.Weights.begin(), layer.Weights.end(), weights.Data());
+		std::copy(layer.Biases.begin(), layer.Biases.end(), biases.Data());
+
+		return Layer(std::move(weights), std::move(biases), m_Functions[index]);
+	}
+
+	template<std::size_t ...Indices>
+	void FromLayers(const std::vector<Layer> &layers, std::index_sequence<Indices...>) {
+		(FromLayer(std::get<Indices>(m_Layers), layers[Indices]), ...);
+	}
+
+	template<std::size_t InputsCount, std::size_t OutputsCount>
+	static void FromLayer(StaticLayer<InputsCount, OutputsCount> &layer, const Layer &source) {
+		std::copy(source.Weights().Data(), source.Weights().Data() + layer.Weights.size(), layer.Weights.begin());
+		std::copy(source.Biases().Data(), source.Biases().Data() + layer.Biases.size(), layer.Biases.begin());
+
+		layer.Kind = ActivationFunction::FindKind(source.FunctionName());
+		layer.Function = source.Function();
+	}
+};
+
+//same stream format as NeuralNetwork, files are interchangeable
+template<std::size_t ...Sizes>
+struct Serializer<StaticNetwork<Sizes...>> {
+	static void ToStream(const StaticNetwork<Sizes...>& network, std::ostream& stream) {
+		Serializer<NeuralNetwork>::ToStream(network.ToNetwork(), stream);
+	}
+
+	static std::optional<StaticNetwork<Sizes...>> FromStream(std::istream& stream) {
+		auto network = Serializer<NeuralNetwork>::FromStream(stream);
+		if(!network.has_value())
+			return std::nullopt;
+
+		return StaticNetwork<Sizes...>::FromNetwork(network.value());
+	}
+};
@@ -0,0 +1,181 @@
+#include "worker_pool.hpp"
+#include <algorithm>
+
+WorkerPool::WorkerPool(std::size_t threads) {
+	if(!threads)
+		threads = HardwareThreads();
+
+	m_Ranges.reset(new WorkRange[threads]);
+
+	for (std::size_t i = 1; i < threads; i++) {
+		m_Threads.emplace_back(&WorkerPool::WorkerLoop, this, i);
+	}
+}
+
+WorkerPool::~WorkerPool() {
+	{
+		std::unique_lock<std::mutex> lock(m_Mutex);
+		m_Stop = true;
+	}
+	m_Wake.notify_all();
+
+	for (auto &thread : m_Threads)
+		thread.join();
+}
+
+void WorkerPool::ParallelFor(std::size_t count, const Task& task) {
+	Run(count, 0, task);
+}
+
+void WorkerPool::ParallelFor(std::size_t count, std::size_t grain, const Task& task) {
+	Run(count, std::max<std::size_t>(grain, 1), task);
+}
+
+void WorkerPool::Run(std::size_t count, std::size_t grain, const Task& task) {
+	if(!count)
+		return;
+
+	if (m_Threads.empty() || count == 1) {
+		for (std::size_t i = 0; i < count; i++)
+			task(i, 0);
+		return;
+	}
+
+	{
+		std::unique_lock<std::mutex> lock(m_Mutex);
+		m_Task = &task;
+		m_Count = count;
+		m_Next = 0;
+		m_Grain = grain;
+		m_Busy = m_Threads.size();
+		m_Generation++;
+
+		//workers are woken after this, so their ranges need no locking here
+		for (std::size_t worker = 0; worker < Size(); worker++) {
+			m_Ranges[worker].Begin = count * worker / Size();
+			m_Ranges[worker].End = count * (worker + 1) / Size();
+		}
+	}
+	m_Wake.notify_all();
+
+	RunTasks(0);
+
+	std::unique_lock<std::mutex> lock(m_Mutex);
+	m_Done.wait(lock, [this]{ return m_Busy == 0; });
+	m_Task = nullptr;
+}
+
+void AppendScaling(std::vector<Scaling>& scaling, std::size_t threads, double items_per_second) {
+	Scaling result;
+	result.Threads = threads;
+	result.ItemsPerSecond = items_per_second;
+	//per thread throughput relative to the first run
+	result.Efficiency = scaling.size() && scaling.front().ItemsPerSecond > 0 ? (items_per_second / threads) / (scaling.front().ItemsPerSecond / scaling.front().Threads) : 1.0;
+
+	scaling.push_back(result);
+}
+
+std::size_t WorkerPool::HardwareThreads() {
+	return std::max(1u, std::thread::hardware_concurrency());
+}
+
+void WorkerPool::WorkerLoop(std::size_t worker) {
+	std::size_t generation = 0;
+
+	for (;;) {
+		{
+			std::unique_lock<std::mutex> lock(m_Mutex);
+			m_Wake.wait(lock, [&]{ return m_Stop || m_Generation != generation; });
+
+			if(m_Stop)
+				return;
+
+			generation = m_Generation;
+		}
+
+		RunTasks(worker);
+
+		std::unique_lock<std::mutex> lock(m_Mutex);
+		if(--m_Busy == 0)
+			m_Done.notify_one();
+	}
+}
+
+void WorkerPool::RunTasks(std::size_t worker) {
+	if (!m_Grain) {
+		for (std::size_t i = m_Next++; i < m_Count; i = m_Next++) {
+			(*m_Task)(i, worker);
+		}
+		return;
+	}
+
+	for (;;) {
+		std::size_t begin = 0, end = 0;
+
+		if (!TakeOwn(worker, begin, end)) {
+			if(!Steal(worker))
+				return;
+			continue;
+		}
+
+		for (std::size_t i = begin; i < end; i++) {
+			(*m_Task)(i, worker);
+		}
+	}
+}
+
+bool WorkerPool::TakeOwn(std::size_t worker, std::size_t& begin, std::size_t& end) {
+	WorkRange &range = m_Ranges[worker];
+	std::unique_lock<std::mutex> lock(range.Mutex);
+
+	if(range.Begin == range.End)
+		return false;
+
+	begin = range.Begin;
+	end = std::min(range.Begin + m_Grain, range.End);
+	range.Begin = end;
+
+	return true;
+}
+
+bool WorkerPool::Steal(std::size_t worker) {
+	//items taken by other thieves but not started yet are theirs to finish, so giving up here loses nothing
+	for (;;) {
+		std::size_t victim = worker;
+		std::size_t largest = 0;
+
+		for (std::size_t other = 0; other < Size(); other++) {
+			if(other == worker)
+				continue;
+
+			std::unique_lock<std::mutex> lock(m_Ranges[other].Mutex);
+			if (m_Ranges[other].End - m_Ranges[other].Begin > largest) {
+				largest = m_Ranges[other].End - m_Ranges[other].Begin;
+				victim = other;
+			}
+		}
+
+		if(!largest)
+			return false;
+
+		std::size_t begin = 0, end = 0;
+		{
+			std::unique_lock<std::mutex> lock(m_Ranges[victim].Mutex);
+			WorkRange &range = m_Ranges[victim];
+
+			//victim might have progressed since the scan
+			if(range.Begin == range.End)
+				continue;
+
+			end = range.End;
+			begin = range.End - (range.End - range.Begin + 1) / 2;
+			range.End = begin;
+		}
+
+		std::unique_lock<std::mutex> lock(m_Ranges[worker].Mutex);
+		m_Ranges[worker].Begin = begin;
+		m_Ranges[worker].End = end;
+
+		return true;
+	}
+}
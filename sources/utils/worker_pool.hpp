@@ -0,0 +1,83 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <functional>
+#include <condition_variable>
+
+//Throughput of one run of a parallel scaling measurement
+struct Scaling {
+	std::size_t Threads = 0;
+	//samples, agent steps or whatever the measured loop processes
+	double ItemsPerSecond = 0;
+	//throughput relative to single thread times number of threads
+	double Efficiency = 0;
+};
+
+//appends a run of threads with items_per_second, first appended run is the baseline for efficiency
+void AppendScaling(std::vector<Scaling> &scaling, std::size_t threads, double items_per_second);
+
+//Persistent threads for short parallel loops that run many times per second, where std::async would
+//spend more time creating threads than working. Calling thread takes part as worker 0
+class WorkerPool {
+public:
+	//index of the item and of the worker running it, worker is below Size()
+	using Task = std::function<void(std::size_t index, std::size_t worker)>;
+private:
+	//items left to a worker in stealing mode, owner takes from the front and thieves from the back
+	struct alignas(64) WorkRange {
+		std::mutex Mutex;
+		std::size_t Begin = 0;
+		std::size_t End = 0;
+	};
+
+	std::vector<std::thread> m_Threads;
+	std::unique_ptr<WorkRange[]> m_Ranges;
+	//0 when items are handed out one at a time from the shared counter
+	std::size_t m_Grain = 0;
+
+	std::mutex m_Mutex;
+	std::condition_variable m_Wake;
+	std::condition_variable m_Done;
+
+	const Task *m_Task = nullptr;
+	std::size_t m_Count = 0;
+	std::atomic<std::size_t> m_Next{0};
+
+	std::size_t m_Generation = 0;
+	std::size_t m_Busy = 0;
+	bool m_Stop = false;
+public:
+	//0 uses every hardware thread
+	explicit WorkerPool(std::size_t threads = 0);
+
+	WorkerPool(const WorkerPool &) = delete;
+	WorkerPool &operator=(const WorkerPool &) = delete;
+
+	~WorkerPool();
+
+	std::size_t Size()const{ return m_Threads.size() + 1; }
+
+	//returns once task has run for every index in [0, count), items are handed out one at a time
+	void ParallelFor(std::size_t count, const Task &task);
+
+	//same with work stealing for items of uneven cost: every worker starts on its own contiguous part,
+	//takes grain items at a time and steals half of the largest part left when it runs out
+	void ParallelFor(std::size_t count, std::size_t grain, const Task &task);
+
+	static std::size_t HardwareThreads();
+
+private:
+	void WorkerLoop(std::size_t worker);
+
+	void RunTasks(std::size_t worker);
+
+	void Run(std::size_t count, std::size_t grain, const Task &task);
+
+	bool TakeOwn(std::size_t worker, std::size_t &begin, std::size_t &end);
+
+	bool Steal(std::size_t worker);
+};